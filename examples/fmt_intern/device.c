@@ -0,0 +1,43 @@
+/* The device side: logs through interned format strings. Each record goes to
+   stdout behind a two-byte little-endian length. Pipe it into npf_fmt_host with
+   this binary's path to read it:
+
+     ./fmt_intern_device | ./fmt_intern_host ./fmt_intern_device */
+
+#include "npf_fmt_config.h"
+#define NANOPRINTF_IMPLEMENTATION
+#include "../../nanoprintf.h"
+
+#include <stdio.h>
+
+typedef struct record {
+  unsigned char buf[256];
+  int len;
+} record_t;
+
+static void record_putc(int c, void *ctx) {
+  record_t *const r = (record_t *)ctx;
+  if (r->len < (int)sizeof(r->buf)) { r->buf[r->len++] = (unsigned char)c; }
+}
+
+static void record_send(record_t const *r) {
+  putchar(r->len & 0xFF);
+  putchar((r->len >> 8) & 0xFF);
+  fwrite(r->buf, 1, (size_t)r->len, stdout);
+}
+
+#define LOG(...) do { \
+    record_t r_; \
+    r_.len = 0; \
+    npf_fmt_send(record_putc, &r_, __VA_ARGS__); \
+    record_send(&r_); \
+  } while (0)
+
+int main(void) {
+  LOG(NPF_FMT("boot: %s v%d.%d"), "radio", 1, 4);
+  for (int i = 0; i < 3; ++i) {
+    LOG(NPF_FMT("rx %u bytes, rssi %d dBm, snr %.1f"), 24u + (unsigned)i, -90 + i, 7.25);
+  }
+  LOG(NPF_FMT("[%-8s] flags=%#06x"), "mac", 0x2Au);
+  return 0;
+}
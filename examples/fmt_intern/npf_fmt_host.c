@@ -0,0 +1,95 @@
+/* The host side: renders npf_fmt_send records back to text. The device image's
+   npf_fmt section holds every format string, and a record's ID is its string's
+   offset in that section, so the ELF is all the table there is.
+
+   Usage: npf_fmt_host ELF < records
+
+   Records arrive as the device example frames them: a two-byte little-endian
+   length, then the record. ELF32 and ELF64, little-endian only. */
+
+#include "npf_fmt_config.h"
+#define NANOPRINTF_IMPLEMENTATION
+#include "../../nanoprintf.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static unsigned long long rd(unsigned char const *p, int n) {
+  unsigned long long v = 0;
+  while (n--) { v = (v << 8) | p[n]; }
+  return v;
+}
+
+static void out_putc(int c, void *ctx) { putc(c, (FILE *)ctx); }
+
+// Finds the npf_fmt section in the ELF image; 0 if it isn't there.
+static int find_fmt_section(unsigned char const *elf, size_t size,
+                            unsigned char const **sec, size_t *sec_size) {
+  if ((size < 64) || memcmp(elf, "\x7f" "ELF", 4) || (elf[5] != 1)) { return 0; }
+  int const is64 = (elf[4] == 2);
+  unsigned long long const shoff = is64 ? rd(elf + 0x28, 8) : rd(elf + 0x20, 4);
+  unsigned const shentsize = (unsigned)rd(elf + (is64 ? 0x3A : 0x2E), 2);
+  unsigned const shnum = (unsigned)rd(elf + (is64 ? 0x3C : 0x30), 2);
+  unsigned const shstrndx = (unsigned)rd(elf + (is64 ? 0x3E : 0x32), 2);
+  if ((shstrndx >= shnum) || (shoff + ((unsigned long long)shnum * shentsize) > size)) {
+    return 0;
+  }
+  unsigned const off_at = is64 ? 0x18u : 0x10u, size_at = is64 ? 0x20u : 0x14u;
+  int const w = is64 ? 8 : 4;
+  unsigned char const *const strtab_sh = elf + shoff + ((size_t)shstrndx * shentsize);
+  unsigned long long const strtab = rd(strtab_sh + off_at, w);
+  for (unsigned i = 0; i < shnum; ++i) {
+    unsigned char const *const sh = elf + shoff + ((size_t)i * shentsize);
+    unsigned long long const name = strtab + rd(sh, 4);
+    unsigned long long const off = rd(sh + off_at, w), len = rd(sh + size_at, w);
+    if ((name + sizeof("npf_fmt") > size) || strcmp((char const *)elf + name, "npf_fmt")) {
+      continue;
+    }
+    if (off + len > size) { return 0; }
+    *sec = elf + off;
+    *sec_size = (size_t)len;
+    return 1;
+  }
+  return 0;
+}
+
+int main(int argc, char **argv) {
+  if (argc != 2) {
+    fprintf(stderr, "usage: %s ELF < records\n", argv[0]);
+    return 2;
+  }
+  FILE *const f = fopen(argv[1], "rb");
+  if (!f) { perror(argv[1]); return 1; }
+  fseek(f, 0, SEEK_END);
+  long const fsize = ftell(f);
+  fseek(f, 0, SEEK_SET);
+  unsigned char *const elf = (unsigned char *)malloc((size_t)(fsize > 0 ? fsize : 1));
+  size_t const size = elf ? fread(elf, 1, (size_t)(fsize > 0 ? fsize : 0), f) : 0;
+  fclose(f);
+
+  unsigned char const *sec = NULL;
+  size_t sec_size = 0;
+  if (!find_fmt_section(elf, size, &sec, &sec_size)) {
+    fprintf(stderr, "%s: no npf_fmt section\n", argv[1]);
+    free(elf);
+    return 1;
+  }
+
+  unsigned char rec[65536];
+  int lo, hi;
+  while (((lo = getchar()) != EOF) && ((hi = getchar()) != EOF)) {
+    int const len = lo | (hi << 8);
+    if (fread(rec, 1, (size_t)len, stdin) != (size_t)len) { break; }
+    unsigned long id = 0;
+    int const hdr = npf_fmt_read_id(rec, len, &id);
+    if (!hdr || (id >= sec_size) || !memchr(sec + id, '\0', sec_size - id)) {
+      printf("<unknown format id %lu>\n", id);
+      continue;
+    }
+    npf_fmt_render(out_putc, stdout, (char const *)sec + id, rec + hdr, len - hdr);
+    putchar('\n');
+  }
+  free(elf);
+  return 0;
+}
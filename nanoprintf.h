@@ -32,14 +32,36 @@ typedef void (*npf_putc)(int c, void *ctx);
 #if defined(NANOPRINTF_USE_FLOAT_SINGLE_PRECISION) && \
     (NANOPRINTF_USE_FLOAT_SINGLE_PRECISION == 1)
 #define NPF_PRINTF_SP_ATTR NPF_PRINTF_ATTR(3, 0)
+#define NPF_PRINTF_SP_ATTR_AT(F, V) NPF_PRINTF_ATTR(F, 0)
 #define NPF_MAP_ARGS(...) NPF__MAP(NPF__WRAP, __VA_ARGS__)
 typedef struct { float val; } npf_float_t;
 #define npf_snprintf_  npf_snprintf_sp_
 #define npf_pprintf_   npf_pprintf_sp_
+#define npf_snprintf_ext_ npf_snprintf_ext_sp_
+#define npf_pprintf_ext_  npf_pprintf_ext_sp_
 #define npf_vsnprintf  npf_vsnprintf_sp
 #define npf_vpprintf   npf_vpprintf_sp
+#define npf_log_       npf_log_sp_
+#define npf_vlog       npf_vlog_sp
+#define npf_strbuf_appendf_ npf_strbuf_appendf_sp_
+#define npf_strbuf_vappendf npf_strbuf_vappendf_sp
+#define npf_asprintf_  npf_asprintf_sp_
+#define npf_vasprintf  npf_vasprintf_sp
+#define npf_asprintf_buf_ npf_asprintf_buf_sp_
+#define npf_vasprintf_buf npf_vasprintf_buf_sp
+#define npf_tee_pprintf_ npf_tee_pprintf_sp_
+#define npf_tee_vpprintf npf_tee_vpprintf_sp
+#define npf_fmt_send_  npf_fmt_send_sp_
+#define npf_fmt_vsend  npf_fmt_vsend_sp
+#define npf_fmt_render npf_fmt_render_sp
+#define npf_ring_log_  npf_ring_log_sp_
+#define npf_ring_vlog  npf_ring_vlog_sp
+#define npf_ring_dump  npf_ring_dump_sp
+#define npf_dedup_pprintf_ npf_dedup_pprintf_sp_
+#define npf_dedup_vpprintf npf_dedup_vpprintf_sp
 #else
 #define NPF_PRINTF_SP_ATTR NPF_PRINTF_ATTR(3, 4)
+#define NPF_PRINTF_SP_ATTR_AT(F, V) NPF_PRINTF_ATTR(F, V)
 #define NPF_MAP_ARGS(...) __VA_ARGS__
 #endif
 
@@ -66,6 +88,16 @@ NPF_VISIBILITY int npf_pprintf_(npf_putc pc,
                                 char const * NPF_RESTRICT format, ...)
                                 NPF_PRINTF_SP_ATTR;
 
+// The same two without the format attribute, for the extensions (e.g. "%U32f") that
+// GCC's and Clang's -Wformat don't know and would warn about.
+NPF_VISIBILITY int npf_snprintf_ext_(char * NPF_RESTRICT buffer,
+                                     size_t bufsz,
+                                     const char * NPF_RESTRICT format, ...);
+
+NPF_VISIBILITY int npf_pprintf_ext_(npf_putc pc,
+                                    void * NPF_RESTRICT pc_ctx,
+                                    char const * NPF_RESTRICT format, ...);
+
 // Public API
 
 // The npf_ functions all return the number of bytes required to express the
@@ -75,6 +107,10 @@ NPF_VISIBILITY int npf_pprintf_(npf_putc pc,
 
 #define npf_snprintf(buf, sz, ...) npf_snprintf_((buf), (sz), NPF_MAP_ARGS(__VA_ARGS__))
 #define npf_pprintf(pc, ctx, ...) npf_pprintf_((pc), (ctx), NPF_MAP_ARGS(__VA_ARGS__))
+#define npf_snprintf_ext(buf, sz, ...) \
+  npf_snprintf_ext_((buf), (sz), NPF_MAP_ARGS(__VA_ARGS__))
+#define npf_pprintf_ext(pc, ctx, ...) \
+  npf_pprintf_ext_((pc), (ctx), NPF_MAP_ARGS(__VA_ARGS__))
 
 NPF_VISIBILITY int npf_vsnprintf(char * NPF_RESTRICT buffer,
                                  size_t bufsz,
@@ -86,6 +122,355 @@ NPF_VISIBILITY int npf_vpprintf(npf_putc pc,
                                 char const * NPF_RESTRICT format,
                                 va_list vlist) NPF_PRINTF_ATTR(3, 0);
 
+#if defined(NANOPRINTF_USE_PROFILE_HOOKS) && (NANOPRINTF_USE_PROFILE_HOOKS == 1)
+/* Per-conversion profiling. Once hooks are installed, npf_vpprintf reports every
+   conversion specifier it parses: begin runs before the argument is fetched, end
+   after the last byte is emitted. Literal text between specifiers isn't reported.
+   Install once at startup; the hooks are shared by every caller on every thread. */
+typedef struct npf_profile_event {
+  char const *spec;        // the specifier in the format string, starting at '%'
+  int spec_len;            // its length in bytes, through the conversion letter
+  char conv_spec;          // the conversion letter as written: 'd', 'X', 'f', '%'...
+  unsigned char length_modifier; // 0 for none; spec spells out which one it is
+  int cbuf_len;            // converted bytes, before sign, prefix and padding (end only)
+  int field_pad;           // bytes of field-width padding (end only)
+  int prec_pad;            // leading zeros from precision or the '0' flag (end only)
+  unsigned long start;     // clock at begin
+  unsigned long cycles;    // clock at end minus start (end only)
+} npf_profile_event_t;
+
+typedef struct npf_profile_hooks {
+  unsigned long (*clock)(void *ctx); // the cycle counter; may be NULL
+  void (*begin)(void *ctx, npf_profile_event_t const *ev); // may be NULL
+  void (*end)(void *ctx, npf_profile_event_t const *ev);   // may be NULL
+  void *ctx;
+} npf_profile_hooks_t;
+
+// hooks must outlive every call that might report to it; NULL uninstalls.
+NPF_VISIBILITY void npf_profile_install(npf_profile_hooks_t const *hooks);
+
+/* A ready-made collector. Install it as the end hook with an npf_profile_hist_t
+   as ctx. Rows are per conversion letter, case-folded, with '%' after 'z'; bucket
+   i counts conversions that took [2^i, 2^(i+1)) cycles, and the last bucket is
+   open-ended. Zero-initialize before use. */
+enum { NPF_PROFILE_HIST_BUCKETS = 16 };
+#define NPF_PROFILE_HIST_ROW(CONV) \
+  (((CONV) == '%') ? 26 : (((CONV) | 32) - 'a'))
+
+typedef struct npf_profile_hist_row {
+  unsigned long count;
+  unsigned long cycles;  // total, for the mean
+  unsigned long max;
+  unsigned long bucket[NPF_PROFILE_HIST_BUCKETS];
+} npf_profile_hist_row_t;
+
+typedef struct npf_profile_hist { npf_profile_hist_row_t row[27]; } npf_profile_hist_t;
+
+NPF_VISIBILITY void npf_profile_hist_end(void *hist, npf_profile_event_t const *ev);
+#endif
+
+#if defined(NANOPRINTF_USE_CUSTOM_FORMAT_SPECIFIERS) && \
+    (NANOPRINTF_USE_CUSTOM_FORMAT_SPECIFIERS == 1)
+/* User conversions. A handler registered for a conversion letter nanoprintf doesn't
+   use is called with that letter's argument and writes straight to the sink, and
+   nanoprintf applies the field width around it. It is called with a NULL pc first
+   when the width needs its length, so it must produce the same bytes both times.
+   Register once at startup; the table is shared by every caller on every thread. */
+enum { NPF_CUSTOM_ARG_INT, NPF_CUSTOM_ARG_LONG, NPF_CUSTOM_ARG_PTR };
+
+typedef struct npf_custom_spec {
+  union { long i; void const *p; } arg; // as registered: int and long both land in i
+  int prec;              // -1 when the specifier has none
+  char conv;             // the letter as written, so e.g. 'M' can mean uppercase
+  char prepend;          // ' ' or '+', or 0
+  char alt_form;         // '#', or 0
+} npf_custom_spec_t;
+
+// Writes the conversion through pc, or only counts it when pc is NULL; returns bytes.
+typedef int (*npf_custom_fn)(npf_putc pc, void *pc_ctx, npf_custom_spec_t const *spec);
+
+/* Binds letter (either case) to fn, which takes one vararg of arg_kind; a NULL fn
+   unbinds it. Returns nonzero on success, 0 if nanoprintf already uses the letter
+   as a conversion or length modifier in this build, or it is past 'x'. */
+NPF_VISIBILITY int npf_custom_register(char letter, int arg_kind, npf_custom_fn fn);
+#endif
+
+#if defined(NANOPRINTF_USE_STRUCTURED_LOG) && (NANOPRINTF_USE_STRUCTURED_LOG == 1)
+/* Structured logging. npf_log writes one record through the sink's encoder. TEXT is
+   what npf_pprintf prints; JSON writes one object and CBOR one map, with a field per
+   conversion and no other text. A field is named by the word before the '=' or ':'
+   the conversion follows, as in "temp=%f id=%u", or numbered from 0 otherwise. */
+enum { NPF_LOG_TEXT, NPF_LOG_JSON, NPF_LOG_CBOR };
+
+typedef struct npf_log_sink {
+  npf_putc pc;
+  void *pc_ctx;
+  int encoding;          // NPF_LOG_TEXT, NPF_LOG_JSON or NPF_LOG_CBOR
+} npf_log_sink_t;
+
+// Both return the number of bytes written. No format attribute: see npf_pprintf_ext.
+NPF_VISIBILITY int npf_log_(npf_log_sink_t const *sink, char const *format, ...);
+NPF_VISIBILITY int npf_vlog(npf_log_sink_t const *sink, char const *format,
+                            va_list vlist);
+
+#define npf_log(sink, ...) npf_log_((sink), NPF_MAP_ARGS(__VA_ARGS__))
+#endif
+
+#if defined(NANOPRINTF_USE_TIMESTAMP_FORMAT_SPECIFIER) && \
+    (NANOPRINTF_USE_TIMESTAMP_FORMAT_SPECIFIER == 1)
+/* Timestamps. "%T" takes a pointer to an npf_timestamp_t and prints its time as
+   seconds and microseconds, "12.000250"; "%#T" prints it as ISO 8601 UTC,
+   "1970-01-01T00:00:12.000250Z". The precision picks 0 to 6 fraction digits.
+   The context keeps the text it last printed and rewrites only the digits that
+   changed since, so give each log stream its own and don't share one between
+   threads. */
+typedef struct npf_timestamp {
+  unsigned long sec;     // since the Unix epoch, for ISO 8601
+  unsigned long usec;    // below 1000000
+  // The cache: zero-initialize with the rest, then leave it alone.
+  unsigned long cached_sec;
+  unsigned char len;     // text bytes before the fraction; 0 until first printed
+  char iso;              // which of the two forms text holds
+  char text[28];
+} npf_timestamp_t;
+#endif
+
+#if defined(NANOPRINTF_USE_STRING_BUILDER) && (NANOPRINTF_USE_STRING_BUILDER == 1)
+/* String building. npf_strbuf_appendf formats onto the end of the builder's text
+   through the npf_putc contract, so nothing is measured twice and nothing already
+   written moves. When a chunk fills, the grow callback hands over the next one and
+   the text carries on there, split wherever the byte fell. npf_strbuf_arena_grow
+   carves chunks out of one caller buffer; a pool or malloc wrapper works the same. */
+typedef struct npf_strbuf_chunk {
+  struct npf_strbuf_chunk *next;
+  char *data;
+  int cap;               // bytes data holds
+  int len;               // bytes of it in use
+} npf_strbuf_chunk_t;
+
+// Returns a chunk with data and cap set and cap >= min, or NULL when out of memory.
+typedef npf_strbuf_chunk_t *(*npf_strbuf_grow_fn)(void *ctx, int min);
+
+typedef struct npf_strbuf {
+  npf_strbuf_chunk_t first; // the buffer npf_strbuf_init was given
+  npf_strbuf_chunk_t *tail;
+  npf_strbuf_grow_fn grow;  // may be NULL: the first chunk is then all there is
+  void *grow_ctx;
+  int len;               // bytes appended, counting dropped ones
+  int dropped;           // bytes lost to a failed grow; every later byte is lost too
+} npf_strbuf_t;
+
+// buf may be NULL with size 0, so that every chunk comes from grow.
+NPF_VISIBILITY void npf_strbuf_init(npf_strbuf_t *sb, char *buf, int size,
+                                    npf_strbuf_grow_fn grow, void *grow_ctx);
+
+// Both return the bytes the format produced, as npf_pprintf does.
+NPF_VISIBILITY int npf_strbuf_appendf_(npf_strbuf_t *sb, char const *format, ...)
+                                       NPF_PRINTF_SP_ATTR_AT(2, 3);
+NPF_VISIBILITY int npf_strbuf_vappendf(npf_strbuf_t *sb, char const *format,
+                                       va_list vlist) NPF_PRINTF_ATTR(2, 0);
+
+#define npf_strbuf_appendf(sb, ...) npf_strbuf_appendf_((sb), NPF_MAP_ARGS(__VA_ARGS__))
+
+// The sink itself, with the npf_strbuf_t as ctx, for npf_pprintf and friends.
+NPF_VISIBILITY void npf_strbuf_putc(int c, void *sb);
+
+// Copies the kept text to dst as npf_snprintf would: cut to size - 1 bytes and
+// NUL-terminated. Returns the kept length.
+NPF_VISIBILITY int npf_strbuf_copy(npf_strbuf_t const *sb, char *dst, size_t size);
+
+/* The kept text as one NUL-terminated string. It stays in place when it all sits
+   in one chunk with a byte to spare; otherwise it is copied once into a chunk of
+   at least len + 1 from grow, and appending carries on from there. NULL if that
+   chunk can't be had. */
+NPF_VISIBILITY char *npf_strbuf_flatten(npf_strbuf_t *sb);
+
+typedef struct npf_strbuf_arena {
+  char *p;               // the first free byte
+  char *end;
+  int chunk;             // data bytes per chunk; 0 hands each chunk all that's left
+} npf_strbuf_arena_t;
+
+// A grow callback over an npf_strbuf_arena_t. Each chunk's header is carved too.
+NPF_VISIBILITY npf_strbuf_chunk_t *npf_strbuf_arena_grow(void *arena, int min);
+#endif
+
+#if defined(NANOPRINTF_USE_ASPRINTF) && (NANOPRINTF_USE_ASPRINTF == 1)
+/* Allocating printf. npf_asprintf counts the formatted length with a pass that
+   writes nothing, then takes exactly length + 1 bytes from the allocator in one
+   call and formats into them. The _buf forms format into the caller's buffer
+   first and only allocate when it overflows; they return buf itself when it fit,
+   so only a result other than buf needs freeing. Each returns NULL when the
+   allocator does. */
+// Returns size bytes, or NULL: malloc, a pool, an arena.
+typedef void *(*npf_alloc_fn)(void *ctx, size_t size);
+
+NPF_VISIBILITY char *npf_asprintf_(npf_alloc_fn alloc, void *alloc_ctx,
+                                   char const *format, ...) NPF_PRINTF_SP_ATTR;
+NPF_VISIBILITY char *npf_vasprintf(npf_alloc_fn alloc, void *alloc_ctx,
+                                   char const *format, va_list vlist)
+                                   NPF_PRINTF_ATTR(3, 0);
+NPF_VISIBILITY char *npf_asprintf_buf_(char *buf, size_t bufsz, npf_alloc_fn alloc,
+                                       void *alloc_ctx, char const *format, ...)
+                                       NPF_PRINTF_SP_ATTR_AT(5, 6);
+NPF_VISIBILITY char *npf_vasprintf_buf(char *buf, size_t bufsz, npf_alloc_fn alloc,
+                                       void *alloc_ctx, char const *format,
+                                       va_list vlist) NPF_PRINTF_ATTR(5, 0);
+
+#define npf_asprintf(alloc, ctx, ...) \
+  npf_asprintf_((alloc), (ctx), NPF_MAP_ARGS(__VA_ARGS__))
+#define npf_asprintf_buf(buf, sz, alloc, ctx, ...) \
+  npf_asprintf_buf_((buf), (sz), (alloc), (ctx), NPF_MAP_ARGS(__VA_ARGS__))
+#endif
+
+#if defined(NANOPRINTF_USE_TEE_SINK) && (NANOPRINTF_USE_TEE_SINK == 1)
+/* Fan-out. npf_tee_putc is an npf_putc that hands each byte to every child sink, so
+   one formatting pass, and one run of each conversion, feeds them all. Each child
+   takes the record classes its filter mask names. npf_tee_pprintf writes a record
+   of one class to just the children that take it, and converts nothing when none
+   of them does. Plain npf_pprintf through npf_tee_putc reaches every child. */
+typedef struct npf_tee_child {
+  npf_putc pc;
+  void *pc_ctx;
+  unsigned filter;       // the classes this child takes; ~0u for all
+} npf_tee_child_t;
+
+typedef struct npf_tee {
+  npf_tee_child_t const *child;
+  int n;
+  unsigned cls;          // the class being written; npf_tee_init sets ~0u
+} npf_tee_t;
+
+NPF_VISIBILITY void npf_tee_init(npf_tee_t *tee, npf_tee_child_t const *child, int n);
+NPF_VISIBILITY void npf_tee_putc(int c, void *tee);
+
+// Both return the bytes each taking child got, or 0 when no child takes cls.
+NPF_VISIBILITY int npf_tee_pprintf_(npf_tee_t *tee, unsigned cls,
+                                    char const *format, ...) NPF_PRINTF_SP_ATTR;
+NPF_VISIBILITY int npf_tee_vpprintf(npf_tee_t *tee, unsigned cls, char const *format,
+                                    va_list vlist) NPF_PRINTF_ATTR(3, 0);
+
+#define npf_tee_pprintf(tee, cls, ...) \
+  npf_tee_pprintf_((tee), (cls), NPF_MAP_ARGS(__VA_ARGS__))
+#endif
+
+#if defined(NANOPRINTF_USE_FORMAT_INTERNING) && (NANOPRINTF_USE_FORMAT_INTERNING == 1)
+/* Format interning, for binary logs. NPF_FMT("...") places a format literal in the
+   npf_fmt linker section and evaluates to it. npf_fmt_send writes a record of the
+   string's ID, its offset in that section, followed by the arguments in binary, so
+   the text never crosses the link. On the host, the ID finds the string in the
+   ELF's npf_fmt section and npf_fmt_render prints the record through nanoprintf.
+   Both ends must agree on NANOPRINTF_USE_LARGE_FORMAT_SPECIFIERS, the float width
+   and the pointer width. ELF targets with GCC or Clang only: the linker defines
+   __start_npf_fmt because the section name is a C identifier. */
+#define NPF_FMT(str) (__extension__ ({ \
+  static char const npf_fmt_str_[] __attribute__((section("npf_fmt"), used)) = str; \
+  &npf_fmt_str_[0]; }))
+
+// The ID of a string NPF_FMT returned.
+NPF_VISIBILITY unsigned long npf_fmt_id(char const *fmt);
+
+/* Writes fmt's record, its ID then its arguments, and returns the record's length.
+   Records aren't framed: send the length along if the transport doesn't. A record
+   ends early at a conversion npf_log couldn't take either, such as %n. */
+NPF_VISIBILITY int npf_fmt_send_(npf_putc pc, void *pc_ctx, char const *fmt, ...)
+                                 NPF_PRINTF_SP_ATTR;
+NPF_VISIBILITY int npf_fmt_vsend(npf_putc pc, void *pc_ctx, char const *fmt,
+                                 va_list vlist) NPF_PRINTF_ATTR(3, 0);
+
+#define npf_fmt_send(pc, ctx, ...) npf_fmt_send_((pc), (ctx), NPF_MAP_ARGS(__VA_ARGS__))
+
+// Reads a record's ID; returns the bytes it took, or 0 if rec is cut short.
+NPF_VISIBILITY int npf_fmt_read_id(void const *rec, int len, unsigned long *id);
+
+// Prints the len bytes of arguments after the ID as fmt, the string the ID names,
+// would have printed them. Returns the bytes printed.
+NPF_VISIBILITY int npf_fmt_render(npf_putc pc, void *pc_ctx, char const *fmt,
+                                  void const *args, int len);
+#endif
+
+#if defined(NANOPRINTF_USE_DEFERRED_LOG) && (NANOPRINTF_USE_DEFERRED_LOG == 1)
+/* Deferred logging into a RAM ring. npf_ring_log stores the format pointer and the
+   raw arguments, sized by each conversion's spec, and formats nothing; when the
+   ring is full the oldest records are overwritten. npf_ring_dump formats what is
+   left, typically from a fault handler. The format must outlive the record, as a
+   literal does. Strings are copied, since the buffers they point to may be gone by
+   the time the ring is read. Calls on one ring must not overlap. */
+typedef struct npf_ring {
+  unsigned char *buf;
+  unsigned cap;
+  unsigned tail; // where the oldest record starts
+  unsigned used;
+  unsigned lost; // records overwritten since init
+} npf_ring_t;
+
+NPF_VISIBILITY void npf_ring_init(npf_ring_t *ring, void *buf, unsigned size);
+
+/* Stores a record and returns its size in the ring. A record stops at a
+   conversion npf_log couldn't take either, such as %n, or at a value that wouldn't
+   fit with the ring to itself, which overwrites nothing; a string that long is cut
+   to fit instead. The dump prints a record up to where it stops. */
+NPF_VISIBILITY int npf_ring_log_(npf_ring_t *ring, char const *format, ...)
+                                 NPF_PRINTF_SP_ATTR_AT(2, 3);
+NPF_VISIBILITY int npf_ring_vlog(npf_ring_t *ring, char const *format,
+                                 va_list vlist) NPF_PRINTF_ATTR(2, 0);
+
+#define npf_ring_log(ring, ...) npf_ring_log_((ring), NPF_MAP_ARGS(__VA_ARGS__))
+
+/* Formats every record, oldest first, and returns the bytes printed. The records
+   stay in the ring, which is rotated so the oldest starts at buf. */
+NPF_VISIBILITY int npf_ring_dump(npf_ring_t *ring, npf_putc pc, void *pc_ctx);
+#endif
+
+#if defined(NANOPRINTF_USE_DEDUP_SINK) && (NANOPRINTF_USE_DEDUP_SINK == 1)
+/* Repeat suppression for log storms. Each record is keyed on its format pointer
+   and a hash of its argument values, taken before any formatting. A record with
+   the same key as the one before it is only counted, and the count is printed as
+   "last message repeated N times\n" once a different record arrives, once window
+   repeats have piled up, or on npf_dedup_flush. Strings are keyed by content.
+   Records npf_log couldn't take, such as ones with %n, are never suppressed. */
+typedef struct npf_dedup {
+  npf_putc pc;
+  void *pc_ctx;
+  unsigned window;   // repeats to count before reporting them anyway; 0 for no limit
+  unsigned repeats;  // of the last record, not reported yet
+  char const *fmt;   // the last record's, or NULL if it can't be repeated
+  unsigned long key; // hash of the last record's values
+} npf_dedup_t;
+
+NPF_VISIBILITY void npf_dedup_init(npf_dedup_t *dd, npf_putc pc, void *pc_ctx,
+                                   unsigned window);
+
+// Both return the bytes this call printed, 0 for a repeat that was counted.
+NPF_VISIBILITY int npf_dedup_pprintf_(npf_dedup_t *dd, char const *format, ...)
+                                      NPF_PRINTF_SP_ATTR_AT(2, 3);
+NPF_VISIBILITY int npf_dedup_vpprintf(npf_dedup_t *dd, char const *format,
+                                      va_list vlist) NPF_PRINTF_ATTR(2, 0);
+
+#define npf_dedup_pprintf(dd, ...) npf_dedup_pprintf_((dd), NPF_MAP_ARGS(__VA_ARGS__))
+
+// Prints the pending repeat count, if there is one, e.g. from a periodic tick.
+NPF_VISIBILITY int npf_dedup_flush(npf_dedup_t *dd);
+#endif
+
+#if defined(NANOPRINTF_USE_FLOAT_EXACT) && (NANOPRINTF_USE_FLOAT_EXACT == 1)
+/* Exact %f/%e/%g. While an arena is installed, those conversions print the exact
+   decimal expansion of their argument, correctly rounded to the precision, as a
+   correctly-rounded libc does; without one they use the default engine. The arena
+   is scratch for one conversion at a time, so calls that format floats must not
+   overlap while it is installed, on other threads or from inside an npf_putc.
+   It must be aligned for uint32_t; size is the most any value needs. */
+#if defined(NANOPRINTF_USE_FLOAT_SINGLE_PRECISION) && \
+    (NANOPRINTF_USE_FLOAT_SINGLE_PRECISION == 1)
+enum { NPF_EXACT_ARENA_SIZE = 21 * 4 };
+#else
+enum { NPF_EXACT_ARENA_SIZE = 124 * 4 };
+#endif
+
+// Returns nonzero if exact mode is now on; a NULL or too-small arena turns it off.
+NPF_VISIBILITY int npf_exact_install(void *arena, size_t size);
+#endif
+
 #ifdef __cplusplus
 }
 #endif
@@ -143,6 +528,20 @@ NPF_VISIBILITY int npf_vpprintf(npf_putc pc,
 #ifndef NANOPRINTF_USE_FIXED_WIDTH_FORMAT_SPECIFIERS
   #define NANOPRINTF_USE_FIXED_WIDTH_FORMAT_SPECIFIERS 0
 #endif
+#ifndef NANOPRINTF_USE_INT128_FORMAT_SPECIFIERS
+  #define NANOPRINTF_USE_INT128_FORMAT_SPECIFIERS 0
+#endif
+
+// Optional flag, defaults to 0 if not explicitly configured. 'W32' and 'W64' take a
+// count and a pointer to that many uint32_t / uint64_t limbs of one big integer.
+#ifndef NANOPRINTF_USE_BIGNUM_FORMAT_SPECIFIERS
+  #define NANOPRINTF_USE_BIGNUM_FORMAT_SPECIFIERS 0
+#endif
+// The widest limb array 'W32' and 'W64' print; wider ones print "ERR". Sizes the
+// scratch on the stack (about a quarter of this, in bytes).
+#ifndef NANOPRINTF_BIGNUM_MAX_BITS
+  #define NANOPRINTF_BIGNUM_MAX_BITS 1024
+#endif
 
 // 'e' and 'g' share a conversion function; 'g' selects between 'e' and 'f' output.
 #if (NANOPRINTF_USE_FLOAT_SCI_FORMAT_SPECIFIER == 1) || \
@@ -158,6 +557,126 @@ NPF_VISIBILITY int npf_vpprintf(npf_putc pc,
   #define NANOPRINTF_USE_DIVISION_FREE_CONVERSION 0
 #endif
 
+// Optional flag, defaults to 0 if not explicitly configured. Conversion letters
+// nanoprintf doesn't use can be bound to handlers; see npf_custom_register.
+#ifndef NANOPRINTF_USE_CUSTOM_FORMAT_SPECIFIERS
+  #define NANOPRINTF_USE_CUSTOM_FORMAT_SPECIFIERS 0
+#endif
+
+// Optional flag, defaults to 0 if not explicitly configured. The 'v' modifier
+// applies one conversion to every element of an array: count, pointer, separator.
+#ifndef NANOPRINTF_USE_ARRAY_FORMAT_SPECIFIERS
+  #define NANOPRINTF_USE_ARRAY_FORMAT_SPECIFIERS 0
+#endif
+
+// Optional flag, defaults to 0 if not explicitly configured. Adds %H, which dumps
+// a block of memory as hex: "%.*H" takes a byte count and a pointer.
+#ifndef NANOPRINTF_USE_HEXDUMP_FORMAT_SPECIFIER
+  #define NANOPRINTF_USE_HEXDUMP_FORMAT_SPECIFIER 0
+#endif
+
+// Optional flag, defaults to 0 if not explicitly configured. Expands hex and
+// binary digits eight at a time in 64-bit registers instead of one per step.
+#ifndef NANOPRINTF_USE_SWAR_DIGIT_CONVERSION
+  #define NANOPRINTF_USE_SWAR_DIGIT_CONVERSION 0
+#endif
+
+// Optional flag, defaults to 0 if not explicitly configured. "%#s" escapes the
+// string for a JSON string body, "%+s" quotes it as a CSV field where needed.
+#ifndef NANOPRINTF_USE_ESCAPED_STRING_FORMAT_SPECIFIERS
+  #define NANOPRINTF_USE_ESCAPED_STRING_FORMAT_SPECIFIERS 0
+#endif
+
+// Optional flag, defaults to 0 if not explicitly configured. Adds %T, which prints
+// a cached timestamp context as seconds.micros or, with '#', as ISO 8601.
+#ifndef NANOPRINTF_USE_TIMESTAMP_FORMAT_SPECIFIER
+  #define NANOPRINTF_USE_TIMESTAMP_FORMAT_SPECIFIER 0
+#endif
+
+// Optional flag, defaults to 0 if not explicitly configured. Adds npf_log, which
+// writes a record as text, JSON or CBOR from one format string.
+#ifndef NANOPRINTF_USE_STRUCTURED_LOG
+  #define NANOPRINTF_USE_STRUCTURED_LOG 0
+#endif
+
+// Optional flag, defaults to 0 if not explicitly configured. Adds npf_strbuf_t,
+// which appends formatted text to a chain of caller-supplied chunks.
+#ifndef NANOPRINTF_USE_STRING_BUILDER
+  #define NANOPRINTF_USE_STRING_BUILDER 0
+#endif
+
+// Optional flag, defaults to 0 if not explicitly configured. Adds npf_asprintf,
+// which sizes the output exactly and allocates it once from a user allocator.
+#ifndef NANOPRINTF_USE_ASPRINTF
+  #define NANOPRINTF_USE_ASPRINTF 0
+#endif
+
+// Optional flag, defaults to 0 if not explicitly configured. Adds npf_tee_t, a sink
+// that delivers one formatting pass to several filtered child sinks.
+#ifndef NANOPRINTF_USE_TEE_SINK
+  #define NANOPRINTF_USE_TEE_SINK 0
+#endif
+
+// Optional flag, defaults to 0 if not explicitly configured. Adds NPF_FMT and
+// npf_fmt_send, which log a format string's ID and binary arguments, not its text.
+#ifndef NANOPRINTF_USE_FORMAT_INTERNING
+  #define NANOPRINTF_USE_FORMAT_INTERNING 0
+#endif
+
+// Optional flag, defaults to 0 if not explicitly configured. Adds npf_ring_t, which
+// keeps log records unformatted in RAM until they are dumped.
+#ifndef NANOPRINTF_USE_DEFERRED_LOG
+  #define NANOPRINTF_USE_DEFERRED_LOG 0
+#endif
+
+// Optional flag, defaults to 0 if not explicitly configured. Adds npf_dedup_t, a
+// sink that counts repeated log records instead of printing them.
+#ifndef NANOPRINTF_USE_DEDUP_SINK
+  #define NANOPRINTF_USE_DEDUP_SINK 0
+#endif
+
+// Optional flag, defaults to 0 if not explicitly configured. Reports each
+// conversion to user hooks; see npf_profile_install.
+#ifndef NANOPRINTF_USE_PROFILE_HOOKS
+  #define NANOPRINTF_USE_PROFILE_HOOKS 0
+#endif
+
+// Optional flag, defaults to 0 if not explicitly configured. A %f too long for the
+// conversion buffer streams its digits to the sink instead of printing "ERR".
+#ifndef NANOPRINTF_USE_FLOAT_STREAMING
+  #define NANOPRINTF_USE_FLOAT_STREAMING 0
+#endif
+
+// Optional flag, defaults to 0 if not explicitly configured. Correctly rounded
+// %f/%e/%g from a caller-provided arena; see npf_exact_install.
+#ifndef NANOPRINTF_USE_FLOAT_EXACT
+  #define NANOPRINTF_USE_FLOAT_EXACT 0
+#endif
+
+// Optional flag, defaults to 0 if not explicitly configured. Exact float digits in
+// a bounded number of steps, for single-precision mode only.
+#ifndef NANOPRINTF_USE_FLOAT_SINGLE_PRECISION_KERNEL
+  #define NANOPRINTF_USE_FLOAT_SINGLE_PRECISION_KERNEL 0
+#endif
+
+// Optional flag, defaults to 0 if not explicitly configured. 'U32' and 'U64' take a
+// float argument as its IEEE-754 bits in a uint32_t / uint64_t.
+#ifndef NANOPRINTF_USE_FLOAT_BITS_FORMAT_SPECIFIERS
+  #define NANOPRINTF_USE_FLOAT_BITS_FORMAT_SPECIFIERS 0
+#endif
+
+// Optional flag, defaults to 0 if not explicitly configured. 'U16' and 'UB16' take
+// the bits of an IEEE-754 binary16 / a bfloat16, the way 'U32' takes a float's.
+#ifndef NANOPRINTF_USE_FLOAT_HALF_FORMAT_SPECIFIERS
+  #define NANOPRINTF_USE_FLOAT_HALF_FORMAT_SPECIFIERS 0
+#endif
+
+// Optional flag, defaults to 0 if not explicitly configured. 'k' and 'r' print an
+// integer as a binary or decimal fixed-point number, without any float code.
+#ifndef NANOPRINTF_USE_FIXED_POINT_FORMAT_SPECIFIERS
+  #define NANOPRINTF_USE_FIXED_POINT_FORMAT_SPECIFIERS 0
+#endif
+
 // If anything's been configured, everything must be configured.
 #ifndef NANOPRINTF_USE_FIELD_WIDTH_FORMAT_SPECIFIERS
   #error NANOPRINTF_USE_FIELD_WIDTH_FORMAT_SPECIFIERS must be #defined to 0 or 1
@@ -196,12 +715,63 @@ NPF_VISIBILITY int npf_vpprintf(npf_putc pc,
   #error Single precision requires float format specifiers to be enabled.
 #endif
 
+#if (NANOPRINTF_USE_FLOAT_STREAMING == 1) && \
+    (NANOPRINTF_USE_FLOAT_FORMAT_SPECIFIERS == 0)
+  #error Float format specifiers must be enabled if float streaming is enabled.
+#endif
+
+#if (NANOPRINTF_USE_FLOAT_EXACT == 1) && \
+    (NANOPRINTF_USE_FLOAT_FORMAT_SPECIFIERS == 0)
+  #error Float format specifiers must be enabled if exact float mode is enabled.
+#endif
+
+#if (NANOPRINTF_USE_FLOAT_SINGLE_PRECISION_KERNEL == 1) && \
+    (NANOPRINTF_USE_FLOAT_SINGLE_PRECISION == 0)
+  #error Single precision must be enabled if the single-precision kernel is enabled.
+#endif
+
+#if (NANOPRINTF_USE_FLOAT_BITS_FORMAT_SPECIFIERS == 1) && \
+    (NANOPRINTF_USE_FLOAT_FORMAT_SPECIFIERS == 0)
+  #error Float format specifiers must be enabled if float bits support is enabled.
+#endif
+
+#if (NANOPRINTF_USE_FLOAT_HALF_FORMAT_SPECIFIERS == 1) && \
+    (NANOPRINTF_USE_FLOAT_BITS_FORMAT_SPECIFIERS == 0)
+  #error Float bits support must be enabled if 16-bit float support is enabled.
+#endif
+
+// A binary16 is an integer over 2^24, so its %f is a fixed-point conversion.
+#if (NANOPRINTF_USE_FIXED_POINT_FORMAT_SPECIFIERS == 1) || \
+    (NANOPRINTF_USE_FLOAT_HALF_FORMAT_SPECIFIERS == 1)
+  #define NPF_USE_QTOA 1
+#else
+  #define NPF_USE_QTOA 0
+#endif
+
+// The single-precision kernel only generates digits, and leaves rounding and layout
+// to npf_etoa_rev, so it compiles that even when 'f' is the only float conversion.
+#if (NPF_USE_SCI == 1) || (NANOPRINTF_USE_FLOAT_SINGLE_PRECISION_KERNEL == 1)
+  #define NPF_USE_ETOA 1
+#else
+  #define NPF_USE_ETOA 0
+#endif
+
 // 'w8' and 'w16' resolve to the 'hh' and 'h' length modifiers.
 #if (NANOPRINTF_USE_FIXED_WIDTH_FORMAT_SPECIFIERS == 1) && \
     (NANOPRINTF_USE_SMALL_FORMAT_SPECIFIERS == 0)
   #error Small format specifiers must be enabled if fixed-width support is enabled.
 #endif
 
+// 'w128' and 'wf128' name the compiler's __int128, and only where it has one.
+#if NANOPRINTF_USE_INT128_FORMAT_SPECIFIERS == 1
+  #if NANOPRINTF_USE_FIXED_WIDTH_FORMAT_SPECIFIERS == 0
+    #error Fixed-width specifiers must be enabled if 128-bit support is enabled.
+  #endif
+  #if !defined(__SIZEOF_INT128__)
+    #error 128-bit format specifiers require a compiler with __int128.
+  #endif
+#endif
+
 /* C23 requires 'wN' to cover every exact-width and minimum-width type stdint.h
    defines, not only the four widths it requires stdint.h to define. Those four
    always name a typedef for char / short / int / long / long long, which is what
@@ -237,8 +807,10 @@ NPF_VISIBILITY int npf_vpprintf(npf_putc pc,
 
 // The conversion buffer must fit at least UINT64_MAX in octal format with the leading '0'.
 // When floats are enabled, a larger buffer is needed for values like FLT_MAX / DBL_MAX.
+// 128-bit integers need 44 bytes, for the same octal.
 #ifndef NANOPRINTF_CONVERSION_BUFFER_SIZE
-  #if NANOPRINTF_USE_FLOAT_FORMAT_SPECIFIERS == 1
+  #if (NANOPRINTF_USE_FLOAT_FORMAT_SPECIFIERS == 1) || \
+      (NANOPRINTF_USE_INT128_FORMAT_SPECIFIERS == 1)
     #define NANOPRINTF_CONVERSION_BUFFER_SIZE  64
   #else
     #define NANOPRINTF_CONVERSION_BUFFER_SIZE  23
@@ -247,6 +819,29 @@ NPF_VISIBILITY int npf_vpprintf(npf_putc pc,
 #if NANOPRINTF_CONVERSION_BUFFER_SIZE < 23
   #error The size of the conversion buffer must be at least 23 bytes.
 #endif
+#if (NANOPRINTF_USE_HEXDUMP_FORMAT_SPECIFIER == 1) && \
+    (NANOPRINTF_USE_PRECISION_FORMAT_SPECIFIERS == 0)
+  #error Hexdump specifier requires precision specifiers (the byte count).
+#endif
+#if (NANOPRINTF_USE_ESCAPED_STRING_FORMAT_SPECIFIERS == 1) && \
+    (NANOPRINTF_USE_ALT_FORM_FLAG == 0)
+  #error Escaped strings require the alt form flag ('#' selects JSON).
+#endif
+#if (NANOPRINTF_USE_FORMAT_INTERNING == 1) && !defined(__GNUC__)
+  #error Format interning needs GCC or Clang for its linker section.
+#endif
+#if (NANOPRINTF_USE_FORMAT_INTERNING == 1) && \
+    (NANOPRINTF_USE_PRECISION_FORMAT_SPECIFIERS == 0)
+  #error Format interning requires precision specifiers (they bound the strings in a record).
+#endif
+#if (NANOPRINTF_USE_BIGNUM_FORMAT_SPECIFIERS == 1) && \
+    ((NANOPRINTF_BIGNUM_MAX_BITS < 64) || (NANOPRINTF_BIGNUM_MAX_BITS % 64))
+  #error NANOPRINTF_BIGNUM_MAX_BITS must be a positive multiple of 64.
+#endif
+#if (NANOPRINTF_USE_INT128_FORMAT_SPECIFIERS == 1) && \
+    (NANOPRINTF_CONVERSION_BUFFER_SIZE < 44)
+  #error The size of the conversion buffer must be at least 44 bytes for 128-bit support.
+#endif
 
 /* The macro is the user's, so it may be an expression and may be unsigned; every
    in-code use goes through this int-typed, parenthesized alias instead. Unsigned
@@ -414,6 +1009,22 @@ enum {
   NPF_FMT_SPEC_LEN_MOD_LARGE_SIZET,     // 'z'
   NPF_FMT_SPEC_LEN_MOD_LARGE_PTRDIFFT,  // 't'
 #endif
+#if NANOPRINTF_USE_INT128_FORMAT_SPECIFIERS == 1
+  NPF_FMT_SPEC_LEN_MOD_INT128,          // 'w128', 'wf128'
+#endif
+#if NANOPRINTF_USE_BIGNUM_FORMAT_SPECIFIERS == 1
+  NPF_FMT_SPEC_LEN_MOD_BIG32,           // 'W32'
+  NPF_FMT_SPEC_LEN_MOD_BIG64,           // 'W64'
+#endif
+#if NANOPRINTF_USE_FLOAT_BITS_FORMAT_SPECIFIERS == 1
+  // Last, so a single >= test tells them from the integer modifiers.
+  NPF_FMT_SPEC_LEN_MOD_FLOAT_BITS32,    // 'U32'
+  NPF_FMT_SPEC_LEN_MOD_FLOAT_BITS64,    // 'U64'
+#if NANOPRINTF_USE_FLOAT_HALF_FORMAT_SPECIFIERS == 1
+  NPF_FMT_SPEC_LEN_MOD_FLOAT_HALF,      // 'U16'
+  NPF_FMT_SPEC_LEN_MOD_FLOAT_BF16,      // 'UB16'
+#endif
+#endif
 };
 
 #if NANOPRINTF_USE_FIXED_WIDTH_FORMAT_SPECIFIERS == 1
@@ -452,6 +1063,15 @@ enum {
   NPF_FMT_SPEC_CONV_PERCENT,      // '%'
   NPF_FMT_SPEC_CONV_CHAR,         // 'c'
   NPF_FMT_SPEC_CONV_STRING,       // 's'
+#if NANOPRINTF_USE_HEXDUMP_FORMAT_SPECIFIER == 1
+  NPF_FMT_SPEC_CONV_HEXDUMP,      // 'H'
+#endif
+#if NANOPRINTF_USE_CUSTOM_FORMAT_SPECIFIERS == 1
+  NPF_FMT_SPEC_CONV_CUSTOM,       // any letter npf_custom_register bound
+#endif
+#if NANOPRINTF_USE_TIMESTAMP_FORMAT_SPECIFIER == 1
+  NPF_FMT_SPEC_CONV_TIMESTAMP,    // 'T'
+#endif
   NPF_FMT_SPEC_CONV_SIGNED_INT,   // 'i', 'd'
 #if NANOPRINTF_USE_BINARY_FORMAT_SPECIFIERS == 1
   NPF_FMT_SPEC_CONV_BINARY,       // 'b'
@@ -460,6 +1080,10 @@ enum {
   NPF_FMT_SPEC_CONV_HEX_INT,      // 'x', 'X'
   NPF_FMT_SPEC_CONV_UNSIGNED_INT, // 'u'
   NPF_FMT_SPEC_CONV_POINTER,      // 'p'
+#if NANOPRINTF_USE_FIXED_POINT_FORMAT_SPECIFIERS == 1
+  NPF_FMT_SPEC_CONV_FIXED_BIN,    // 'k', 'K'
+  NPF_FMT_SPEC_CONV_FIXED_DEC,    // 'r', 'R'
+#endif
 #if NANOPRINTF_USE_WRITEBACK_FORMAT_SPECIFIERS == 1
   NPF_FMT_SPEC_CONV_WRITEBACK,    // 'n'
 #endif
@@ -491,6 +1115,18 @@ NPF_CONV_ORDER_ASSERT(text_convs_before_numeric,
   (NPF_FMT_SPEC_CONV_PERCENT < NPF_FMT_SPEC_CONV_SIGNED_INT) &&
   (NPF_FMT_SPEC_CONV_CHAR < NPF_FMT_SPEC_CONV_SIGNED_INT) &&
   (NPF_FMT_SPEC_CONV_STRING < NPF_FMT_SPEC_CONV_SIGNED_INT));
+#if NANOPRINTF_USE_HEXDUMP_FORMAT_SPECIFIER == 1
+NPF_CONV_ORDER_ASSERT(hexdump_conv_before_numeric,
+  NPF_FMT_SPEC_CONV_HEXDUMP < NPF_FMT_SPEC_CONV_SIGNED_INT);
+#endif
+#if NANOPRINTF_USE_CUSTOM_FORMAT_SPECIFIERS == 1
+NPF_CONV_ORDER_ASSERT(custom_conv_before_numeric,
+  NPF_FMT_SPEC_CONV_CUSTOM < NPF_FMT_SPEC_CONV_SIGNED_INT);
+#endif
+#if NANOPRINTF_USE_TIMESTAMP_FORMAT_SPECIFIER == 1
+NPF_CONV_ORDER_ASSERT(timestamp_conv_before_numeric,
+  NPF_FMT_SPEC_CONV_TIMESTAMP < NPF_FMT_SPEC_CONV_SIGNED_INT);
+#endif
 #if NANOPRINTF_USE_BINARY_FORMAT_SPECIFIERS == 1
 NPF_CONV_ORDER_ASSERT(int_convs_contiguous,
   NPF_FMT_SPEC_CONV_UNSIGNED_INT == NPF_FMT_SPEC_CONV_SIGNED_INT + 4);
@@ -500,6 +1136,12 @@ NPF_CONV_ORDER_ASSERT(int_convs_contiguous,
 #endif
 NPF_CONV_ORDER_ASSERT(pointer_after_int_convs,
   NPF_FMT_SPEC_CONV_POINTER > NPF_FMT_SPEC_CONV_UNSIGNED_INT);
+#if NANOPRINTF_USE_FIXED_POINT_FORMAT_SPECIFIERS == 1
+// The integer branch tells the fixed-point convs apart with one >= FIXED_BIN test.
+NPF_CONV_ORDER_ASSERT(fixed_convs_last_ints,
+  (NPF_FMT_SPEC_CONV_FIXED_BIN == NPF_FMT_SPEC_CONV_POINTER + 1) &&
+  (NPF_FMT_SPEC_CONV_FIXED_DEC == NPF_FMT_SPEC_CONV_FIXED_BIN + 1));
+#endif
 #if NANOPRINTF_USE_FLOAT_FORMAT_SPECIFIERS == 1
 #if NANOPRINTF_USE_WRITEBACK_FORMAT_SPECIFIERS == 1
 NPF_CONV_ORDER_ASSERT(float_convs_last,
@@ -544,6 +1186,9 @@ typedef struct npf_format_spec {
   char alt_form;         // '#'
 #endif
   char case_adjust;      // 'a' - 'A' , or 0 (must be non-negative to work)
+#if NANOPRINTF_USE_ARRAY_FORMAT_SPECIFIERS == 1
+  char array;            // 'v'
+#endif
   uint8_t length_modifier;
   uint8_t conv_spec;
 } npf_format_spec_t;
@@ -562,6 +1207,16 @@ typedef struct npf_format_spec {
   #define NPF_UINT_IS_WIDE (UINTPTR_MAX > 0xFFFFFFFFu)
 #endif
 
+#if NANOPRINTF_USE_INT128_FORMAT_SPECIFIERS == 1
+  __extension__ typedef __int128 npf_i128_t; // __extension__: quiet under -pedantic
+  __extension__ typedef unsigned __int128 npf_u128_t;
+  // Every target with __int128 has 64-bit registers; the chunks below rely on it.
+  typedef char npf_uint_holds_u64[(sizeof(npf_uint_t) >= 8) ? 1 : -1];
+  typedef npf_u128_t npf_binval_t;
+#else
+  typedef npf_uint_t npf_binval_t;
+#endif
+
 typedef struct npf_bufputc_ctx {
   char *dst;       // moving cursor; advances on each write while len > 0.
   size_t len;      // remaining capacity; decrements on each successful write.
@@ -597,9 +1252,86 @@ static char const *npf_fmt_num(char const *cur, int *out) {
 }
 #endif
 
+// The conv_spec of each letter, indexed by (lowercased letter - 'a'); 0 for a letter
+// this build doesn't convert.
+static uint8_t const npf_conv_lookup[24] = {
+#if NANOPRINTF_USE_FLOAT_FORMAT_SPECIFIERS == 1 && NANOPRINTF_USE_FLOAT_HEX_FORMAT_SPECIFIER == 1
+  NPF_FMT_SPEC_CONV_FLOAT_HEX,      // 'a'
+#else
+  0,                                 // 'a'
+#endif
+#if NANOPRINTF_USE_BINARY_FORMAT_SPECIFIERS == 1
+  NPF_FMT_SPEC_CONV_BINARY,          // 'b'
+#else
+  0,                                 // 'b'
+#endif
+  NPF_FMT_SPEC_CONV_CHAR,            // 'c'
+  NPF_FMT_SPEC_CONV_SIGNED_INT,      // 'd'
+  // A conv whose feature is compiled out maps to 0, fails to parse, and is
+  // emitted verbatim. That's the signal that the build is misconfigured.
+#if NANOPRINTF_USE_FLOAT_SCI_FORMAT_SPECIFIER == 1
+  NPF_FMT_SPEC_CONV_FLOAT_SCI,       // 'e'
+#else
+  0,                                 // 'e'
+#endif
+#if NANOPRINTF_USE_FLOAT_FORMAT_SPECIFIERS == 1
+  NPF_FMT_SPEC_CONV_FLOAT_DEC,       // 'f'
+#else
+  0,                                 // 'f'
+#endif
+#if NANOPRINTF_USE_FLOAT_SHORTEST_FORMAT_SPECIFIER == 1
+  NPF_FMT_SPEC_CONV_FLOAT_SHORTEST,  // 'g'
+#else
+  0,                                 // 'g'
+#endif
+#if NANOPRINTF_USE_HEXDUMP_FORMAT_SPECIFIER == 1
+  NPF_FMT_SPEC_CONV_HEXDUMP,         // 'H' ('h' is a length modifier)
+#else
+  0,                                 // 'h' (length modifier)
+#endif
+  NPF_FMT_SPEC_CONV_SIGNED_INT,      // 'i'
+  0,                                 // 'j'
+#if NANOPRINTF_USE_FIXED_POINT_FORMAT_SPECIFIERS == 1
+  NPF_FMT_SPEC_CONV_FIXED_BIN,       // 'k'
+#else
+  0,                                 // 'k'
+#endif
+  0, 0,                              // 'l', 'm'
+#if NANOPRINTF_USE_WRITEBACK_FORMAT_SPECIFIERS == 1
+  NPF_FMT_SPEC_CONV_WRITEBACK,       // 'n'
+#else
+  0,                                 // 'n'
+#endif
+  NPF_FMT_SPEC_CONV_OCTAL,           // 'o'
+  NPF_FMT_SPEC_CONV_POINTER,         // 'p'
+  0,                                 // 'q'
+#if NANOPRINTF_USE_FIXED_POINT_FORMAT_SPECIFIERS == 1
+  NPF_FMT_SPEC_CONV_FIXED_DEC,       // 'r'
+#else
+  0,                                 // 'r'
+#endif
+  NPF_FMT_SPEC_CONV_STRING,          // 's'
+#if NANOPRINTF_USE_TIMESTAMP_FORMAT_SPECIFIER == 1
+  NPF_FMT_SPEC_CONV_TIMESTAMP,       // 'T' ('t' is a length modifier)
+#else
+  0,                                 // 't'
+#endif
+  NPF_FMT_SPEC_CONV_UNSIGNED_INT,    // 'u'
+  0, 0,                              // 'v', 'w'
+  NPF_FMT_SPEC_CONV_HEX_INT,         // 'x'
+};
+
 // Returns a pointer one past the last consumed character on success, null on
 // failure. A pointer return inlines into npf_vpprintf with smaller code than
 // a length return (the caller continues from the returned cursor directly).
+#if NANOPRINTF_USE_CUSTOM_FORMAT_SPECIFIERS == 1
+// One slot per entry of npf_conv_lookup, indexed the same way.
+static struct npf_custom_slot {
+  npf_custom_fn fn;
+  uint8_t arg_kind;
+} npf_custom_slots[24];
+#endif
+
 static char const *npf_parse_format_spec_end(char const *format,
                                              npf_format_spec_t *out_spec) {
   char const *cur = format;
@@ -662,6 +1394,14 @@ static char const *npf_parse_format_spec_end(char const *format,
   }
 #endif
 
+#if NANOPRINTF_USE_ARRAY_FORMAT_SPECIFIERS == 1
+  out_spec->array = 0;
+  if (*cur == 'v') { // before the length modifier, which then names the element type
+    out_spec->array = 'v';
+    ++cur;
+  }
+#endif
+
   out_spec->length_modifier = NPF_FMT_SPEC_LEN_MOD_NONE;
 #if NANOPRINTF_USE_FIXED_WIDTH_FORMAT_SPECIFIERS == 1
   if (*cur == 'w') {
@@ -674,6 +1414,12 @@ static char const *npf_parse_format_spec_end(char const *format,
        arithmetic is spent building one. */
     char const c = *cur++;
     char d2 = 0;
+#if NANOPRINTF_USE_INT128_FORMAT_SPECIFIERS == 1
+    if ((c == '1') && (cur[0] == '2') && (cur[1] == '8')) {
+      out_spec->length_modifier = NPF_FMT_SPEC_LEN_MOD_INT128; // least == fast here
+      cur += 2;
+    } else
+#endif
     if (c == '1') { out_spec->length_modifier = NPF_LM_OF_W(fast, 16); d2 = '6'; }
     else if (c == '3') { out_spec->length_modifier = NPF_LM_OF_W(fast, 32); d2 = '2'; }
 #if NPF_W_BITS_MAX == 64
@@ -709,6 +1455,37 @@ static char const *npf_parse_format_spec_end(char const *format,
 #if NANOPRINTF_USE_FLOAT_FORMAT_SPECIFIERS == 1
     case 'L': out_spec->length_modifier = NPF_FMT_SPEC_LEN_MOD_LONG_DOUBLE; break;
 #endif
+#if NANOPRINTF_USE_FLOAT_BITS_FORMAT_SPECIFIERS == 1
+    /* Only the widths with an IEEE-754 format behind them. Single-precision mode
+       has no binary64 arithmetic to decode one with, so 'U64' doesn't parse there. */
+    case 'U':
+      if ((cur[0] == '3') && (cur[1] == '2')) {
+        out_spec->length_modifier = NPF_FMT_SPEC_LEN_MOD_FLOAT_BITS32;
+#if NANOPRINTF_USE_FLOAT_SINGLE_PRECISION == 0
+      } else if ((cur[0] == '6') && (cur[1] == '4')) {
+        out_spec->length_modifier = NPF_FMT_SPEC_LEN_MOD_FLOAT_BITS64;
+#endif
+#if NANOPRINTF_USE_FLOAT_HALF_FORMAT_SPECIFIERS == 1
+      } else if ((cur[0] == '1') && (cur[1] == '6')) {
+        out_spec->length_modifier = NPF_FMT_SPEC_LEN_MOD_FLOAT_HALF;
+      } else if ((cur[0] == 'B') && (cur[1] == '1') && (cur[2] == '6')) {
+        out_spec->length_modifier = NPF_FMT_SPEC_LEN_MOD_FLOAT_BF16;
+        ++cur;
+#endif
+      } else { return NULL; }
+      cur += 2;
+      break;
+#endif
+#if NANOPRINTF_USE_BIGNUM_FORMAT_SPECIFIERS == 1
+    case 'W':
+      if ((cur[0] == '3') && (cur[1] == '2')) {
+        out_spec->length_modifier = NPF_FMT_SPEC_LEN_MOD_BIG32;
+      } else if ((cur[0] == '6') && (cur[1] == '4')) {
+        out_spec->length_modifier = NPF_FMT_SPEC_LEN_MOD_BIG64;
+      } else { return NULL; }
+      cur += 2;
+      break;
+#endif
 #if NANOPRINTF_USE_LARGE_FORMAT_SPECIFIERS == 1
     case 'j': out_spec->length_modifier = NPF_FMT_SPEC_LEN_MOD_LARGE_INTMAX; break;
     case 'z': out_spec->length_modifier = NPF_FMT_SPEC_LEN_MOD_LARGE_SIZET; break;
@@ -717,64 +1494,84 @@ static char const *npf_parse_format_spec_end(char const *format,
     default: --cur; break;
   }
 
-  // Conversion specifier. Look up the conv_spec from a 24-byte table indexed by
-  // (lowercased letter - 'a'). '%' is handled out-of-line since it's the only
-  // non-letter conversion. case_adjust gets bit 5 of the original char.
+  // Conversion specifier, from npf_conv_lookup. '%' is handled out-of-line since
+  // it's the only non-letter conversion. case_adjust gets bit 5 of the original char.
   char const c = *cur++;
   uint_fast8_t cs;
   if (c == '%') {
     cs = NPF_FMT_SPEC_CONV_PERCENT;
   } else {
-    static const uint8_t lookup[24] = {
-#if NANOPRINTF_USE_FLOAT_FORMAT_SPECIFIERS == 1 && NANOPRINTF_USE_FLOAT_HEX_FORMAT_SPECIFIER == 1
-      NPF_FMT_SPEC_CONV_FLOAT_HEX,      // 'a'
-#else
-      0,                                 // 'a'
+    unsigned const idx = (unsigned)((c | 32) - 'a');
+    if (idx >= sizeof(npf_conv_lookup)) { return NULL; }
+    cs = npf_conv_lookup[idx];
+#if NANOPRINTF_USE_CUSTOM_FORMAT_SPECIFIERS == 1
+    // Only a slot the build leaves empty can hold a user conversion.
+    if (!cs && npf_custom_slots[idx].fn) { cs = NPF_FMT_SPEC_CONV_CUSTOM; }
 #endif
-#if NANOPRINTF_USE_BINARY_FORMAT_SPECIFIERS == 1
-      NPF_FMT_SPEC_CONV_BINARY,          // 'b'
-#else
-      0,                                 // 'b'
+    if (!cs) { return NULL; }
+  }
+#if NANOPRINTF_USE_INT128_FORMAT_SPECIFIERS == 1
+  // Only the integer conversions and %n have a 128-bit type to take.
+  if ((out_spec->length_modifier == NPF_FMT_SPEC_LEN_MOD_INT128) &&
+      ((cs < NPF_FMT_SPEC_CONV_SIGNED_INT) || (cs > NPF_FMT_SPEC_CONV_UNSIGNED_INT))
+#if NANOPRINTF_USE_WRITEBACK_FORMAT_SPECIFIERS == 1
+      && (cs != NPF_FMT_SPEC_CONV_WRITEBACK)
 #endif
-      NPF_FMT_SPEC_CONV_CHAR,            // 'c'
-      NPF_FMT_SPEC_CONV_SIGNED_INT,      // 'd'
-      // A conv whose feature is compiled out maps to 0, fails to parse, and is
-      // emitted verbatim. That's the signal that the build is misconfigured.
-#if NANOPRINTF_USE_FLOAT_SCI_FORMAT_SPECIFIER == 1
-      NPF_FMT_SPEC_CONV_FLOAT_SCI,       // 'e'
-#else
-      0,                                 // 'e'
+     ) { return NULL; }
 #endif
-#if NANOPRINTF_USE_FLOAT_FORMAT_SPECIFIERS == 1
-      NPF_FMT_SPEC_CONV_FLOAT_DEC,       // 'f'
-#else
-      0,                                 // 'f'
+#if NANOPRINTF_USE_ARRAY_FORMAT_SPECIFIERS == 1
+  // An array element is a value; these take more than one vararg or write one.
+  if (out_spec->array && ((cs == NPF_FMT_SPEC_CONV_PERCENT)
+#if NANOPRINTF_USE_WRITEBACK_FORMAT_SPECIFIERS == 1
+      || (cs == NPF_FMT_SPEC_CONV_WRITEBACK)
 #endif
-#if NANOPRINTF_USE_FLOAT_SHORTEST_FORMAT_SPECIFIER == 1
-      NPF_FMT_SPEC_CONV_FLOAT_SHORTEST,  // 'g'
-#else
-      0,                                 // 'g'
+#if NANOPRINTF_USE_FIXED_POINT_FORMAT_SPECIFIERS == 1
+      || (cs == NPF_FMT_SPEC_CONV_FIXED_BIN) || (cs == NPF_FMT_SPEC_CONV_FIXED_DEC)
 #endif
-      0,                                 // 'h' (length modifier)
-      NPF_FMT_SPEC_CONV_SIGNED_INT,      // 'i'
-      0, 0, 0, 0,                        // 'j', 'k', 'l', 'm'
-#if NANOPRINTF_USE_WRITEBACK_FORMAT_SPECIFIERS == 1
-      NPF_FMT_SPEC_CONV_WRITEBACK,       // 'n'
-#else
-      0,                                 // 'n'
-#endif
-      NPF_FMT_SPEC_CONV_OCTAL,           // 'o'
-      NPF_FMT_SPEC_CONV_POINTER,         // 'p'
-      0, 0,                              // 'q', 'r'
-      NPF_FMT_SPEC_CONV_STRING,          // 's'
-      0,                                 // 't'
-      NPF_FMT_SPEC_CONV_UNSIGNED_INT,    // 'u'
-      0, 0,                              // 'v', 'w'
-      NPF_FMT_SPEC_CONV_HEX_INT,         // 'x'
-    };
-    unsigned const idx = (unsigned)((c | 32) - 'a');
-    if (idx >= sizeof(lookup) || !(cs = lookup[idx])) { return NULL; }
+#if NANOPRINTF_USE_HEXDUMP_FORMAT_SPECIFIER == 1
+      || (cs == NPF_FMT_SPEC_CONV_HEXDUMP)
+#endif
+#if NANOPRINTF_USE_TIMESTAMP_FORMAT_SPECIFIER == 1
+      || (cs == NPF_FMT_SPEC_CONV_TIMESTAMP)
+#endif
+#if NANOPRINTF_USE_BIGNUM_FORMAT_SPECIFIERS == 1
+      || (out_spec->length_modifier == NPF_FMT_SPEC_LEN_MOD_BIG32)
+      || (out_spec->length_modifier == NPF_FMT_SPEC_LEN_MOD_BIG64)
+#endif
+     )) { return NULL; }
+#endif
+#if NANOPRINTF_USE_CUSTOM_FORMAT_SPECIFIERS == 1
+  // The argument's type was fixed at registration.
+  if ((cs == NPF_FMT_SPEC_CONV_CUSTOM) &&
+      (out_spec->length_modifier != NPF_FMT_SPEC_LEN_MOD_NONE)) { return NULL; }
+#endif
+#if NANOPRINTF_USE_HEXDUMP_FORMAT_SPECIFIER == 1
+  // %H takes no length modifier, and its byte count is the precision.
+  if ((cs == NPF_FMT_SPEC_CONV_HEXDUMP) &&
+      ((out_spec->length_modifier != NPF_FMT_SPEC_LEN_MOD_NONE) ||
+       (out_spec->prec_opt == NPF_FMT_SPEC_OPT_NONE))) { return NULL; }
+#endif
+#if NANOPRINTF_USE_TIMESTAMP_FORMAT_SPECIFIER == 1
+  // %T takes a pointer to its context and nothing else. Only uppercase: "%td" must
+  // stay unparsed where ptrdiff_t's 't' is compiled out.
+  if ((cs == NPF_FMT_SPEC_CONV_TIMESTAMP) &&
+      ((c & 32) || (out_spec->length_modifier != NPF_FMT_SPEC_LEN_MOD_NONE))) {
+    return NULL;
+  }
+#endif
+#if NANOPRINTF_USE_BIGNUM_FORMAT_SPECIFIERS == 1
+  // A limb array is an unsigned integer; %d and %i only add the '+' / ' ' flags.
+  if (((out_spec->length_modifier == NPF_FMT_SPEC_LEN_MOD_BIG32) ||
+       (out_spec->length_modifier == NPF_FMT_SPEC_LEN_MOD_BIG64)) &&
+      ((cs < NPF_FMT_SPEC_CONV_SIGNED_INT) || (cs > NPF_FMT_SPEC_CONV_UNSIGNED_INT))) {
+    return NULL;
   }
+#endif
+#if NANOPRINTF_USE_FLOAT_BITS_FORMAT_SPECIFIERS == 1
+  // The bits modifiers name a float, so only the float conversions take them.
+  if ((out_spec->length_modifier >= NPF_FMT_SPEC_LEN_MOD_FLOAT_BITS32) &&
+      (cs < NPF_FMT_SPEC_CONV_FLOAT_DEC)) { return NULL; }
+#endif
   out_spec->conv_spec = (uint8_t)cs;
   out_spec->case_adjust = (char)(c & 32); // 32 for lowercase, 0 for uppercase
 
@@ -800,8 +1597,63 @@ static NPF_NOINLINE uint32_t npf_div10(uint32_t n) {
 }
 #endif
 
+#if (NANOPRINTF_USE_SWAR_DIGIT_CONVERSION == 1) || \
+    (NANOPRINTF_USE_HEXDUMP_FORMAT_SPECIFIER == 1)
+/* SIMD within a register: spread a 32-bit value one nibble per byte of a 64-bit
+   word, least significant nibble in the low byte, then turn all eight into ASCII
+   at once. */
+static uint64_t npf_hex8(uint32_t v, char case_adj) {
+  uint64_t x = v;
+  x = (x | (x << 16)) & 0x0000FFFF0000FFFFu;
+  x = (x | (x << 8)) & 0x00FF00FF00FF00FFu;
+  x = (x | (x << 4)) & 0x0F0F0F0F0F0F0F0Fu;
+  // Each byte holding 10..15 carries into bit 4 and gets the gap from '9' to 'A'.
+  uint64_t const alpha = ((x + 0x0606060606060606u) >> 4) & 0x0101010101010101u;
+  return x + 0x3030303030303030u + (alpha * (uint64_t)(('A' - '9' - 1) + case_adj));
+}
+#endif
+
+#if NANOPRINTF_USE_SWAR_DIGIT_CONVERSION == 1
+// The digits land least significant first, as the reversed conversion buffer wants.
+static void npf_hex8_rev(uint32_t v, char *buf, char case_adj) {
+  uint64_t const x = npf_hex8(v, case_adj);
+  for (int i = 0; i < 8; ++i) { buf[i] = (char)(x >> (8 * i)); }
+}
+
+// Drops the leading zeros npf_hex8_rev wrote past the top digit; keeps one.
+static char *npf_hex_rev_trim(char const *buf, char *end) {
+  while (((end - buf) > 1) && (end[-1] == '0')) { --end; }
+  return end;
+}
+
+// The same spreading for bits: out gets the low 8 bits of b, most significant first.
+static void npf_bits8(unsigned b, char *out) {
+  uint64_t x = b & 0xFFu;
+  x = (x | (x << 28)) & 0x0000000F0000000Fu;
+  x = (x | (x << 14)) & 0x0003000300030003u;
+  x = ((x | (x << 7)) & 0x0101010101010101u) + 0x3030303030303030u;
+  for (int i = 0; i < 8; ++i) { out[7 - i] = (char)(x >> (8 * i)); }
+}
+#endif
+
 static NPF_NOINLINE char *npf_utoa_rev_end(
     npf_uint_t val, char *buf, uint_fast8_t base, char case_adj) {
+#if NANOPRINTF_USE_SWAR_DIGIT_CONVERSION == 1
+  if (base == 16u) {
+    char *p = buf;
+    for (;;) {
+      npf_hex8_rev((uint32_t)val, p, case_adj);
+      p += 8;
+#if NPF_UINT_IS_WIDE
+      val = (npf_uint_t)((val >> 16) >> 16); // no shift by the full width of a 32-bit type
+      if (!val) { break; }
+#else
+      break;
+#endif
+    }
+    return npf_hex_rev_trim(buf, p);
+  }
+#endif
 #if (NANOPRINTF_USE_LARGE_FORMAT_SPECIFIERS == 1) || \
     ((NANOPRINTF_USE_DIVISION_FREE_CONVERSION == 1) && NPF_UINT_IS_WIDE)
   // Use shift and subtract here to avoid hw div operation
@@ -845,6 +1697,54 @@ static NPF_FORCE_INLINE int npf_utoa_rev(
   return (int)(npf_utoa_rev_end(val, buf, base, case_adj) - buf);
 }
 
+#if NANOPRINTF_USE_INT128_FORMAT_SPECIFIERS == 1
+/* Divides *n by 10^19 and returns the remainder. 10^19 is the largest power of ten
+   below 2^64 and already has its top bit set, so each 128-by-64 step takes its
+   precomputed reciprocal, a multiply-high and at most two corrections (Moller and
+   Granlund, "Improved division by invariant integers") instead of __udivti3. */
+static uint64_t npf_div1e19(npf_u128_t *n) {
+  uint64_t const d = 10000000000000000000u, v = 0xD83C94FB6D2AC34Au;
+  uint64_t hi = (uint64_t)(*n >> 64), qh = 0;
+  uint64_t const lo = (uint64_t)*n;
+  if (hi >= d) { qh = 1; hi -= d; } // the high quotient word is 0 or 1
+  npf_u128_t const p = ((npf_u128_t)v * hi) + (((npf_u128_t)hi << 64) | lo);
+  uint64_t q = (uint64_t)(p >> 64) + 1, r = lo - (q * d);
+  if (r > (uint64_t)p) { --q; r += d; }
+  if (r >= d) { ++q; r -= d; }
+  *n = ((npf_u128_t)qh << 64) | q;
+  return r;
+}
+
+/* npf_utoa_rev for 128 bits. Decimal comes out 19 digits per chunk, each chunk in
+   64-bit arithmetic; octal and hex are shifted straight out of the value. */
+static int npf_u128toa_rev(npf_u128_t val, char *buf, uint_fast8_t base, char case_adj) {
+  char *p = buf;
+  if (base == 10u) {
+    int n = 19; // every chunk but the top one is zero-padded to 19 digits
+    uint64_t r;
+    do {
+      if (val >> 64) { r = npf_div1e19(&val); } else { r = (uint64_t)val; val = 0; n = 1; }
+      // Division by a constant: a multiply-high on every target with __int128.
+      do { *p++ = (char)('0' + (r % 10u)); r /= 10u; } while ((--n > 0) || r);
+    } while (val);
+    return (int)(p - buf);
+  }
+#if NANOPRINTF_USE_SWAR_DIGIT_CONVERSION == 1
+  if (base == 16u) {
+    do { npf_hex8_rev((uint32_t)val, p, case_adj); p += 8; val >>= 32; } while (val);
+    return (int)(npf_hex_rev_trim(buf, p) - buf);
+  }
+#endif
+  uint_fast8_t const shift = (uint_fast8_t)((base + 16u) >> 3); // 8 -> 3, 16 -> 4
+  do {
+    int_fast8_t const d = (int_fast8_t)(val & (base - 1u));
+    *p++ = (char)(((d < 10) ? '0' : ('A' - 10 + case_adj)) + d);
+    val >>= shift;
+  } while (val);
+  return (int)(p - buf);
+}
+#endif
+
 #if NANOPRINTF_USE_FLOAT_FORMAT_SPECIFIERS == 1
 
 #include <float.h>
@@ -913,6 +1813,56 @@ static NPF_FORCE_INLINE npf_real_bin_t npf_real_to_int_rep(npf_real_t f) {
   return bin;
 }
 
+#if (NANOPRINTF_USE_FLOAT_BITS_FORMAT_SPECIFIERS == 1) || \
+    (NANOPRINTF_USE_FORMAT_INTERNING == 1)
+static NPF_FORCE_INLINE npf_real_t npf_real_from_int_rep(npf_real_bin_t bin) {
+  npf_real_t f;
+  char const *src = (char const *)&bin;
+  char *dst = (char *)&f;
+  for (uint_fast8_t i = 0; i < sizeof(f); ++i) { dst[i] = src[i]; }
+  return f;
+}
+#endif
+
+#if ((NANOPRINTF_USE_FLOAT_SINGLE_PRECISION == 1) && \
+     (NANOPRINTF_USE_FLOAT_HEX_FORMAT_SPECIFIER == 1)) || \
+    ((NANOPRINTF_USE_FLOAT_SINGLE_PRECISION == 0) && \
+     (NANOPRINTF_USE_FLOAT_BITS_FORMAT_SPECIFIERS == 1))
+/* Widens binary32 bits to binary64 bits. Exact, like the cast, but in integer
+   arithmetic: without an FPU the cast is a call into the soft-float library. */
+static uint_fast64_t npf_bits32_to_bits64(uint_fast32_t b) {
+  uint_fast32_t e = (b >> 23) & 0xFFu, m = b & 0x7FFFFFu;
+  if (e == 0xFFu) {
+    e = 0x7FFu;
+  } else if (e) {
+    e += 1023u - 127u;
+  } else if (m) { // subnormal: normalize, and the leading 1 becomes the hidden bit
+    e = 1023u - 126u;
+    while (!(m & 0x800000u)) { m <<= 1; --e; }
+    m &= 0x7FFFFFu;
+  }
+  return ((uint_fast64_t)((b >> 31) & 1u) << 63) | ((uint_fast64_t)e << 52) |
+         ((uint_fast64_t)m << 29);
+}
+#endif
+
+#if NANOPRINTF_USE_FLOAT_HALF_FORMAT_SPECIFIERS == 1
+// Widens binary16 bits to binary32 bits, the same way.
+static uint_fast32_t npf_half_to_bits32(uint_fast32_t h) {
+  uint_fast32_t e = (h >> 10) & 0x1Fu, m = h & 0x3FFu;
+  if (e == 0x1Fu) {
+    e = 0xFFu;
+  } else if (e) {
+    e += 127u - 15u;
+  } else if (m) { // subnormal: every one is normal in binary32
+    e = 127u - 14u;
+    while (!(m & 0x400u)) { m <<= 1; --e; }
+    m &= 0x3FFu;
+  }
+  return ((h & 0x8000u) << 16) | (e << 23) | (m << 13);
+}
+#endif
+
 #if NANOPRINTF_USE_DIVISION_FREE_CONVERSION == 1
 // Variable shifts of 64-bit values call sw helpers on archs
 // without 64-bit shifters. Perfer 1 bit shits to keep in 32 bit word spce.
@@ -938,7 +1888,9 @@ static NPF_FORCE_INLINE npf_real_bin_t npf_bin_shl(npf_real_bin_t v, int_fast8_t
    'e' does not know the decimal exponent until the digits are generated and
    rounded, so it generates digits plus an exponent and lays out afterwards. When
    'e' or 'g' is enabled, 'f' uses that generator too rather than adding a second
-   one, which is why npf_ftoa_rev is compiled out in those configurations.
+   one, which is why npf_ftoa_rev is compiled out in those configurations. The
+   single-precision kernel below only replaces npf_etoa_rev's digit generation, so it
+   compiles npf_etoa_rev for 'f' as well.
 
    The two are held to each other by tests/unit_f_paths.cc. */
 
@@ -959,7 +1911,7 @@ static int npf_ftoa_special(char *buf, char case_adj, uint_fast8_t off) {
 #define NPF_FTOA_INF 4u
 #define NPF_FTOA_ERR 8u
 
-#if NPF_USE_SCI == 0
+#if NPF_USE_ETOA == 0
 static int npf_ftoa_rev(
     char *buf, npf_format_spec_t const *spec, int prec, npf_real_t f) {
   uint_fast8_t sp; sp = NPF_FTOA_ERR;
@@ -1144,9 +2096,119 @@ static int npf_ftoa_rev(
 exit:
   return npf_ftoa_special(buf, spec->case_adjust, sp);
 }
-#endif // NPF_USE_SCI == 0
+#endif // NPF_USE_ETOA == 0
+
+#if NPF_USE_ETOA == 1
+
+#if NANOPRINTF_USE_FLOAT_SINGLE_PRECISION_KERNEL == 1
+/* npf_etoa_rev's digit generation, specialized for float. The base-2 to base-10
+   scaling takes a step per binary exponent, 149 of them for the smallest subnormal, and its 32-bit
+   mantissa drops digits past the ninth or so. A float is small enough to hold
+   exactly instead: its integer part fits in four 32-bit limbs and its fraction in
+   five. The integer part is split into base-10^9 chunks by division, and the
+   fraction is multiplied by 10^9 to shift the next nine digits out of its top, so
+   every digit is exact and comes nine per step.
+
+   Each step is a 32x32->64 multiply per fraction limb, or, only for an integer part
+   past 2^32, a 64-bit division by 10^9 per integer limb. The integer part takes at
+   most five steps and the fraction at most ceil(149/9), since every multiply shifts
+   nine more zeros in at the bottom; generation usually stops well before either.
+
+   The digits go right-aligned at the top of buf with 'dec' and 'tail' meaning what
+   they mean in npf_etoa_rev, so rounding and layout are unchanged. Returns 'end'. */
+#define NPF_F32_FRAC ((((uint_fast64_t)1) << 57) - 1)
+static int npf_f32_digits(char *buf, uint32_t m, int e2, int lo, int dstop, int fmode,
+                          int *dec, uint_fast8_t *tail) {
+  uint32_t w[5] = { 0, 0, 0, 0, 0 }; // the integer part, then the fraction * 2^160
+  uint32_t chunk[5];                 // the integer part in base 10^9, low chunk first
+  int top = 0, nc = 0, wl = 5, end = NPF_CBUF, i, n;
+  uint_fast8_t lead = 1;
+
+  if (e2 >= 0) { // m << e2 straddles at most two limbs
+    top = e2 >> 5;
+    w[top] = m << (e2 & 31);
+    if ((e2 & 31) > 8) { w[++top] = m >> (32 - (e2 & 31)); }
+  } else if (e2 > -24) {
+    w[0] = m >> -e2;
+  }
+  do { // the 64-bit division is only for an integer part past 2^32
+    if (top) {
+      uint_fast64_t r = 0;
+      for (i = top; i >= 0; --i) {
+        r = (r << 32) | w[i];
+        w[i] = (uint32_t)(r / 1000000000u);
+        r %= 1000000000u;
+      }
+      chunk[nc++] = (uint32_t)r;
+      top -= !w[top];
+    } else {
+      chunk[nc++] = w[0] % 1000000000u;
+      w[0] /= 1000000000u;
+    }
+  } while (top || w[0]);
+
+  if (e2 < 0) { // the fraction's bits sit below bit 160, whatever the exponent
+    int const pos = 160 + e2;
+    uint32_t const fm = (e2 > -24) ? (m & ((1u << -e2) - 1u)) : m;
+    wl = pos >> 5;
+    w[wl] = fm << (pos & 31);
+    if (((pos & 31) > 8) && (wl < 4)) { w[wl + 1] = fm >> (32 - (pos & 31)); }
+    while ((wl < 5) && !w[wl]) { ++wl; }
+  }
 
-#if NPF_USE_SCI == 1
+  /* Integer chunks high to low, then fraction chunks, nine digits each. 'dec' is the
+     exponent of the last digit taken; it starts above the top chunk's nine, whose
+     leading zeros are skipped as magnitude. 'e' keeps skipping zeros into the
+     fraction for a value under 1, but 'f' always prints the units digit. */
+  *dec = 9 * nc;
+  *tail = 1;
+  for (;;) {
+    uint_fast64_t y;
+    uint32_t v;
+    if (nc) {
+      v = chunk[--nc];
+    } else if (wl < 5) { // only limbs above the lowest nonzero one can change
+      uint_fast64_t x = 0;
+      for (i = wl; i < 5; ++i) {
+        x += (uint_fast64_t)w[i] * 1000000000u;
+        w[i] = (uint32_t)x;
+        x >>= 32;
+      }
+      v = (uint32_t)x;
+      while ((wl < 5) && !w[wl]) { ++wl; }
+    } else {
+      break;
+    }
+    // Leading zeros only move 'dec', so shift them out while the chunk is 32 bits.
+    for (n = 9; lead && n && (v < 100000000u) && (!fmode || (*dec > 1)); --n) {
+      v *= 10u;
+      --*dec;
+    }
+    lead = (uint_fast8_t)(lead && !n);
+    /* The chunk as a 57-bit fixed-point fraction of 10^9, most significant digit in
+       the integer bits. 2^57/10^8 is rounded up, and the excess stays under the gap
+       to the next digit boundary through all nine digits, so each digit is exact
+       and takes a multiply by 10 rather than a division. */
+    y = (uint_fast64_t)v * 1441151881u;
+    for (; n; --n) {
+      char c = (char)('0' + (char)(y >> 57));
+      y = (y & NPF_F32_FRAC) * 10u;
+      if ((end <= lo) || (*dec <= dstop)) { // whatever is left decides 'tail'
+        while ((c == '0') && --n) {
+          c = (char)('0' + (char)(y >> 57));
+          y = (y & NPF_F32_FRAC) * 10u;
+        }
+        while (nc && !chunk[nc - 1]) { --nc; }
+        *tail = (uint_fast8_t)((c == '0') && !nc && (wl == 5));
+        return end;
+      }
+      buf[--end] = c;
+      --*dec;
+    }
+  }
+  return end;
+}
+#endif
 
 /* Scientific ('e'/'E') and shortest ('g'/'G') conversions.
 
@@ -1165,7 +2227,6 @@ exit:
 static int npf_etoa_rev(char *buf, npf_format_spec_t const *spec, npf_real_t f) {
   // A 'goto exit' jumps over these, so none of them may have an initializer.
   int prec, nsig_max, nsig, dec, end, x, pe, fmode, dstop;
-  npf_ftoa_exp_t exp0;
 #if NANOPRINTF_USE_FLOAT_SHORTEST_FORMAT_SPECIFIER == 1
   int g, strip;
 #endif
@@ -1225,17 +2286,16 @@ static int npf_etoa_rev(char *buf, npf_format_spec_t const *spec, npf_real_t f)
   }
   exp = (npf_ftoa_exp_t)(exp - NPF_REAL_EXP_BIAS);
 
-  exp0 = exp;
-#if NANOPRINTF_USE_FLOAT_SHORTEST_FORMAT_SPECIFIER == 1
-regen: // only 'g' comes back here, to switch from significance to position bounds
-#endif
-  exp = exp0; // generation clobbers exp to invalidate the fraction part
   carry = 0;
+#if NANOPRINTF_USE_FLOAT_SINGLE_PRECISION_KERNEL == 1
+  end = npf_f32_digits(buf, (uint32_t)bin, (int)exp - NPF_REAL_MAN_BITS,
+                       NPF_CBUF - nsig_max - 1, dstop, fmode, &dec, &tail);
+#else
   dec = 0;
   // An exponent the integer scaling has to walk down loses remainders, so no tie is
   // visible there. Anything else starts out able to see one; the fraction part
   // below refines this to whether the digits it generates are the whole expansion.
-  tail = (uint_fast8_t)(exp0 <= NPF_FTOA_SHIFT_BITS);
+  tail = (uint_fast8_t)(exp <= NPF_FTOA_SHIFT_BITS);
 
   { // Integer part
     npf_ftoa_man_t man_i;
@@ -1386,6 +2446,7 @@ regen: // only 'g' comes back here, to switch from significance to position boun
       tail = (uint_fast8_t)!man_f;
     }
   }
+#endif
 
   // No digits generated means the value is zero: one '0' digit at exponent 0. The
   // scaling loop above will have walked 'dec' down while chasing a nonzero digit.
@@ -1432,19 +2493,14 @@ regen: // only 'g' comes back here, to switch from significance to position boun
     // Stripping moves 'dec' and 'nsig' by the same amount, so 'x' is unaffected.
     if (strip) { while ((nsig > 1) && (buf[end] == '0')) { ++end; --nsig; ++dec; } }
     if ((x >= -4) && (x < prec)) {
-      /* C11 7.21.6.1p8: style 'f' with precision prec-1-x. That wants digits down
-         to a decimal position rather than a count of them, and 'f' generation also
-         writes the leading zeros and the units digit that 'e' folds into the
-         exponent, so this regenerates instead of relaying out the run already in
-         the buffer. Same two passes npf_ftoa_rev used to provide, minus the second
-         copy of the conversion. */
+      /* C11 7.21.6.1p8: style 'f' with precision prec-1-x. Its last digit sits at
+         the same decimal position as the last of the prec significant digits just
+         rounded, so those digits are already the answer, and only the layout
+         changes. A carry that added a digit left a '0' in the position 'f' drops,
+         so it agrees there too. */
       int const fp = (strip ? nsig : prec) - 1 - x;
       prec = (fp > 0) ? fp : 0;
       fmode = 1;
-      nsig_max = NPF_CBUF - 1;
-      dstop = -prec - 1;
-      g = 0; // one trip through here is enough
-      goto regen;
     }
   }
 #endif
@@ -1452,17 +2508,22 @@ regen: // only 'g' comes back here, to switch from significance to position boun
   if (fmode) { /* Compose "<int>.<frac>" reversed from buf[0] up.
 
     Everything is derived from nsig and dec, the exponent of the least significant
-    generated digit, so the digits occupy exponents dec through dec+nsig-1:
+    generated digit, so the digits occupy exponents dec through top = dec+nsig-1:
       id  generated digits that land in the integer part
       iz  integer trailing zeros, when the digits stop above the units
+      iu  the units '0', when every digit is in the fraction
+      fl  fraction leading zeros, between the point and the digits
       fd  generated digits that land in the fraction
       fz  fraction trailing zeros, padding out to the precision
-    Reversed, the order runs least significant first: fz, fd, point, iz, id. */
-    int const above = nsig + ((dec > 0) ? 0 : dec); // generated digits at 10^0 or up
-    int const id = (above < 0) ? 0 : above;
+    'f' generates from the units digit down, so only 'g' produces iu and fl.
+    Reversed, the order runs least significant first: fz, fd, fl, point, iz, id/iu. */
+    int const top = dec + nsig - 1;
+    int const id = (top < 0) ? 0 : (top + 1 - ((dec > 0) ? dec : 0));
     int const iz = (dec > 0) ? dec : 0;             // integer zeros below the digits
+    int const iu = !id;
+    int const fl = (top < -1) ? (-1 - top) : 0;
     int const fd = nsig - id;                       // generated fraction digits
-    int const fz = prec - fd;                       // fraction zeros past the digits
+    int const fz = prec - fl - fd;                  // fraction zeros past the digits
     int dp = (prec > 0);
     int o = 0, i;
 #if NANOPRINTF_USE_ALT_FORM_FLAG == 1
@@ -1470,12 +2531,14 @@ regen: // only 'g' comes back here, to switch from significance to position boun
 #endif
     // Same lockstep argument as the 'e' layout: reads and writes both walk up, so
     // the gap is tightest at the last read and this one check covers it.
-    if ((id + iz + dp + prec) > NPF_CBUF) { goto exit; }
+    if ((id + iz + iu + dp + prec) > NPF_CBUF) { goto exit; }
     for (i = fz; i > 0; --i) { buf[o++] = '0'; }
     for (i = 0; i < fd; ++i) { buf[o++] = buf[end + i]; }
+    for (i = fl; i > 0; --i) { buf[o++] = '0'; }
     buf[o] = '.'; o += dp;
     for (i = iz; i > 0; --i) { buf[o++] = '0'; }
     for (i = 0; i < id; ++i) { buf[o++] = buf[end + fd + i]; }
+    if (iu) { buf[o++] = '0'; }
     return o;
   }
 
@@ -1514,41 +2577,466 @@ exit:
   return npf_ftoa_special(buf, spec->case_adjust, sp);
 }
 
-#endif // NPF_USE_SCI
+#endif // NPF_USE_ETOA
+
+#if NANOPRINTF_USE_FLOAT_STREAMING == 1
+/* %f for results that don't fit in the conversion buffer: 1e300, or a precision
+   past NPF_CBUF. The arithmetic is npf_ftoa_rev's step for step, so wherever both
+   produce digits they produce the same ones, but the digits go to the sink most
+   significant first instead of into buf reversed. Neither magnitude nor precision
+   is bounded by anything but NPF_FMT_NUM_MAX, and the stack use is constant.
+
+   The one thing a stream can't do is take a digit back, and rounding wants to:
+   9.996 at precision 2 carries into digits that are already generated. So the last
+   digit that isn't a 9 is held back, along with the 9s after it, until a digit
+   arrives that a carry could no longer reach past. A carry bumps the held digit
+   and turns the 9s into 0s; with no held digit at all, the number grows a '1'.
+
+   pc == NULL only counts. npf_vpprintf makes that pass first, because field width
+   padding goes out before the digits and needs to know how many there are. */
+typedef struct npf_fstream {
+  npf_putc pc;
+  void *pc_ctx;
+  int n;        // characters out so far, '.' included
+  int digits;   // digits out so far
+  int int_len;  // digits before the '.'
+  int nines;    // 9s after held, not out yet
+  char dot;     // emit '.' after int_len digits
+  char held;    // the last digit that isn't a 9, not out yet; 0 when there is none
+} npf_fstream_t;
+
+static void npf_fstream_out(npf_fstream_t *s, char c) {
+  if (s->pc) { s->pc(c, s->pc_ctx); }
+  ++s->n;
+  if ((++s->digits == s->int_len) && s->dot) {
+    if (s->pc) { s->pc('.', s->pc_ctx); }
+    ++s->n;
+  }
+}
 
-#if NANOPRINTF_USE_FLOAT_HEX_FORMAT_SPECIFIER == 1
+static void npf_fstream_digit(npf_fstream_t *s, char c) {
+  if (c == '9') { ++s->nines; return; }
+  if (s->held) { npf_fstream_out(s, s->held); }
+  for (; s->nines; --s->nines) { npf_fstream_out(s, '9'); }
+  s->held = c;
+}
 
-// Hex float always operates on IEEE 754 binary64 (double).
-// When not in single-precision mode, npf_real_* already handles double.
-#if NANOPRINTF_USE_FLOAT_SINGLE_PRECISION == 1
-typedef uint_fast64_t npf_double_bin_t;
-enum {
-  NPF_DOUBLE_EXP_MASK = 2047,
-  NPF_DOUBLE_EXP_BIAS = 1023,
-  NPF_DOUBLE_MAN_BITS = 52,
-};
-static NPF_FORCE_INLINE npf_double_bin_t npf_double_to_int_rep(double f) {
-  npf_double_bin_t bin = 0;
-  char const *src = (char const *)&f;
-  char *dst = (char *)&bin;
-  for (uint_fast8_t i = 0; i < sizeof(f); ++i) { dst[i] = src[i]; }
-  return bin;
+static void npf_fstream_flush(npf_fstream_t *s, uint_fast8_t carry) {
+  char nine = '9';
+  if (carry) {
+    nine = '0';
+    if (s->held) { ++s->held; } else { ++s->int_len; s->held = '1'; } // nothing is out
+  }
+  if (s->held) { npf_fstream_out(s, s->held); s->held = 0; }
+  for (; s->nines; --s->nines) { npf_fstream_out(s, nine); }
 }
-#else
-typedef npf_real_bin_t npf_double_bin_t;
-#define NPF_DOUBLE_EXP_MASK NPF_REAL_EXP_MASK
-#define NPF_DOUBLE_EXP_BIAS NPF_REAL_EXP_BIAS
-#define NPF_DOUBLE_MAN_BITS NPF_REAL_MAN_BITS
-#define npf_double_to_int_rep(f) npf_real_to_int_rep(f)
-#endif
 
-static NPF_NOINLINE int npf_atoa_rev(
-    char *buf, npf_format_spec_t const *spec, double f) {
-  npf_double_bin_t bin = npf_double_to_int_rep(f);
+static NPF_NOINLINE int npf_ftoa_stream(npf_putc pc, void *pc_ctx,
+    npf_format_spec_t const *spec, int prec, npf_real_t f) {
+  npf_real_bin_t bin = npf_real_to_int_rep(f);
   npf_ftoa_exp_t exp =
-    (npf_ftoa_exp_t)((npf_ftoa_exp_t)(bin >> NPF_DOUBLE_MAN_BITS) & NPF_DOUBLE_EXP_MASK);
-  bin &= ((npf_double_bin_t)0x1 << NPF_DOUBLE_MAN_BITS) - 1;
-
+    (npf_ftoa_exp_t)((npf_ftoa_exp_t)(bin >> NPF_REAL_MAN_BITS) & NPF_REAL_EXP_MASK);
+  bin &= ((npf_real_bin_t)0x1 << NPF_REAL_MAN_BITS) - 1;
+  if (exp) { bin |= (npf_real_bin_t)0x1 << NPF_REAL_MAN_BITS; } else { ++exp; }
+  exp = (npf_ftoa_exp_t)(exp - NPF_REAL_EXP_BIAS);
+
+  npf_fstream_t s;
+  s.pc = pc;
+  s.pc_ctx = pc_ctx;
+  s.n = s.digits = s.nines = 0;
+  s.held = 0;
+  s.dot = (char)(prec != 0);
+#if NANOPRINTF_USE_ALT_FORM_FLAG == 1
+  s.dot = (char)(s.dot | spec->alt_form);
+#else
+  (void)spec;
+#endif
+
+  uint_fast8_t carry = 0;
+  npf_ftoa_man_t man_i = 0;
+  int zeros = 0; // trailing zeros of the integer part, from the base-2 scaling
+
+  if (exp >= 0) { // Integer part, as in npf_ftoa_rev
+    int_fast8_t shift_i =
+      (int_fast8_t)((exp > NPF_FTOA_SHIFT_BITS) ? (int)NPF_FTOA_SHIFT_BITS : exp);
+    npf_ftoa_exp_t exp_i = (npf_ftoa_exp_t)(exp - shift_i);
+    shift_i = (int_fast8_t)(NPF_REAL_MAN_BITS - shift_i);
+    if (shift_i) {
+      npf_real_bin_t const bin_i = NPF_BIN_SHR(bin, shift_i - 1);
+      carry = (uint_fast8_t)(bin_i & 0x1);
+      man_i = (npf_ftoa_man_t)(bin_i >> 1);
+    } else {
+      man_i = (npf_ftoa_man_t)bin;
+    }
+    if (exp_i) { exp = NPF_REAL_MAN_BITS; } // invalidate the fraction part
+
+    for (; exp_i; --exp_i) {
+      if (!(man_i >> (NPF_FTOA_MAN_BITS - 1))) {
+        man_i = (npf_ftoa_man_t)((man_i << 1) | carry); carry = 0;
+      } else {
+        ++zeros;
+#if NANOPRINTF_USE_DIVISION_FREE_CONVERSION == 1
+        if (sizeof(man_i) <= sizeof(uint32_t)) { // n/5 = 2*(n/10) + (n%10 >= 5)
+          uint32_t const q = npf_div10((uint32_t)man_i);
+          uint_fast8_t r = (uint_fast8_t)((uint32_t)man_i - (q * 10u));
+          man_i = (npf_ftoa_man_t)(q * 2u);
+          if (r >= 5u) { r = (uint_fast8_t)(r - 5u); ++man_i; }
+          carry = (uint_fast8_t)((r + carry + 1u) >> 2);
+        } else
+#endif
+        {
+          carry = (uint_fast8_t)(((uint_fast8_t)(man_i % 5) + carry + 1u) >> 2);
+          man_i /= 5;
+        }
+      }
+    }
+  }
+
+  char last; // the last digit kept, for ties to even
+  { // man_i's digits, then the zeros. Reversed first; log10(2) < 3/10 sizes it.
+    char rev[(sizeof(npf_ftoa_man_t) * CHAR_BIT * 3 + 9) / 10];
+    int i = 0;
+    if ((sizeof(npf_ftoa_man_t) <= sizeof(uint32_t)) &&
+        (sizeof(npf_uint_t) >= sizeof(uint32_t))) { // honors division-free, as in ftoa
+      i = (int)(npf_utoa_rev_end((npf_uint_t)man_i, rev, 10, 0) - rev);
+    } else {
+      do { rev[i++] = (char)('0' + (char)(man_i % 10)); man_i /= 10; } while (man_i);
+    }
+    s.int_len = i + zeros;
+    last = rev[0];
+    while (i) { npf_fstream_digit(&s, rev[--i]); }
+  }
+
+  if (exp >= NPF_REAL_MAN_BITS) {
+    // No fraction bits: the carry rounds man_i itself, ahead of the zeros.
+    npf_fstream_flush(&s, carry);
+    for (; zeros; --zeros) { npf_fstream_digit(&s, '0'); }
+    for (; prec; --prec) { npf_fstream_digit(&s, '0'); }
+    carry = 0;
+  } else { // Fraction part, as in npf_ftoa_rev
+    int_fast8_t shift_f = (int_fast8_t)((exp < 0) ? -1 : exp);
+    npf_ftoa_exp_t exp_f = (npf_ftoa_exp_t)(exp - shift_f);
+    npf_real_bin_t bin_f =
+      NPF_BIN_SHL(bin, (NPF_REAL_BIN_BITS - NPF_REAL_MAN_BITS) + shift_f);
+    npf_ftoa_man_t man_f;
+
+    if (NPF_REAL_BIN_BITS > NPF_FTOA_MAN_BITS) {
+      man_f = (npf_ftoa_man_t)(bin_f >> ((unsigned)(NPF_REAL_BIN_BITS -
+                                                    NPF_FTOA_MAN_BITS) %
+                                         NPF_REAL_BIN_BITS));
+      carry = (uint_fast8_t)((bin_f >> ((unsigned)(NPF_REAL_BIN_BITS -
+                                                   NPF_FTOA_MAN_BITS - 1) %
+                                        NPF_REAL_BIN_BITS)) & 0x1);
+    } else {
+      man_f = (npf_ftoa_man_t)((npf_ftoa_man_t)bin_f
+                               << ((unsigned)(NPF_FTOA_MAN_BITS -
+                                              NPF_REAL_BIN_BITS) % NPF_FTOA_MAN_BITS));
+      carry = 0;
+    }
+
+    for (uint_fast8_t digit = 0; prec && (exp_f < 4); ++exp_f) {
+      if ((man_f > ((npf_ftoa_man_t)-4 / 5)) || digit) {
+        carry = (uint_fast8_t)(man_f & 0x1);
+        man_f = (npf_ftoa_man_t)(man_f >> 1);
+      } else {
+        man_f = (npf_ftoa_man_t)(man_f * 5);
+        if (carry) { man_f = (npf_ftoa_man_t)(man_f + 3); carry = 0; }
+        if (exp_f < 0) {
+          npf_fstream_digit(&s, last = '0');
+          --prec;
+        } else {
+          ++digit;
+        }
+      }
+    }
+    if (man_f != (npf_ftoa_man_t)-1) { man_f = (npf_ftoa_man_t)(man_f + carry); }
+    carry = (exp_f >= 0);
+
+    if (prec) {
+      for (;;) {
+        last = (char)('0' + (char)(man_f >> (NPF_FTOA_MAN_BITS - 4)));
+        npf_fstream_digit(&s, last);
+        man_f = (npf_ftoa_man_t)(man_f & ~((npf_ftoa_man_t)0xF << (NPF_FTOA_MAN_BITS - 4)));
+        if (!--prec) { break; }
+        man_f = (npf_ftoa_man_t)(man_f * 10);
+      }
+      man_f = (npf_ftoa_man_t)(man_f << 4);
+    }
+    carry &= (uint_fast8_t)(man_f >> (NPF_FTOA_MAN_BITS - 1));
+    if (man_f == ((npf_ftoa_man_t)0x1 << (NPF_FTOA_MAN_BITS - 1))) {
+      carry &= (uint_fast8_t)(last & 1);
+    }
+  }
+
+  npf_fstream_flush(&s, carry);
+  return s.n;
+}
+#endif
+
+#if NANOPRINTF_USE_FLOAT_EXACT == 1
+/* Exact %f, %e and %g, for when the digits have to match a correctly rounded libc
+   to the last one; the engines above stop being exact after about 9 significant
+   digits. The value is m * 2^e, and it is expanded into base-10^9 limbs in the
+   arena, most significant first, with the units limb just before 'r':
+
+     e >= 0  multiply by 2^29 at a time. The integer part only grows, at the front.
+     e < 0   divide by 2^9 at a time. 10^9 is a multiple of 2^9, so each step is
+             exact and grows the fraction by at most one limb, at the back.
+
+   The fraction only grows as far as the conversion can see: limbs past its guard
+   digit fold into 'sticky' as they appear, which is exact because a division
+   step only moves remainders toward the back. So %.6f of 1e-300 never holds more
+   than a few limbs, and the arena size only matters for the long expansions.
+   %e/%g don't know their last digit until they know the first; a lower bound on
+   it from the binary exponent stands in, costing at most a limb of extra work.
+
+   Rounding is to nearest, ties to even, on the exact remainder. The digits stay
+   in the limbs, and npf_exact_put reads them straight from there, so neither the
+   magnitude nor the precision is bounded by the conversion buffer. */
+
+#if NANOPRINTF_USE_FLOAT_SINGLE_PRECISION == 1
+  #define NPF_REAL_MIN_EXP FLT_MIN_EXP
+#else
+  #define NPF_REAL_MIN_EXP DBL_MIN_EXP
+#endif
+
+enum { NPF_EXACT_LIMBS = NPF_EXACT_ARENA_SIZE / 4 };
+
+/* The smallest subnormal has NPF_REAL_MANT_DIG - NPF_REAL_MIN_EXP fraction bits,
+   so that many / 9 division steps, each adding a limb after the 3 for the carry
+   slot and m's two. Any integer part needs fewer: 2^1024 is 35 limbs. */
+typedef char npf_exact_arena_fits[
+  (NPF_EXACT_LIMBS >= 4 + (NPF_REAL_MANT_DIG - NPF_REAL_MIN_EXP + 8) / 9) ? 1 : -1];
+
+static uint32_t const npf_exact_pow10[10] = {
+  1u, 10u, 100u, 1000u, 10000u, 100000u, 1000000u, 10000000u, 100000000u, 1000000000u
+};
+
+static uint32_t *npf_exact_arena;
+
+int npf_exact_install(void *arena, size_t size) {
+  npf_exact_arena = (size >= (size_t)NPF_EXACT_ARENA_SIZE) ? (uint32_t *)arena : NULL;
+  return npf_exact_arena != NULL;
+}
+
+typedef struct npf_exact {
+  uint32_t const *l; // the limbs; NULL when the conversion isn't exact
+  int a, z;          // first nonzero limb, one past the last one kept
+  int r;             // one past the units limb
+  int x;             // decimal position of the most significant digit, 0 for zero
+  int prec;          // digits after the point
+  char dot;          // emit the point
+  char e_char;       // 'e' or 'E' for the exponent style, 0 for the fixed style
+} npf_exact_t;
+
+// Floor division by 9, for decimal positions: digit p lives in limb r-1-(p/9).
+static int npf_exact_div9(int p) { return (p >= 0) ? (p / 9) : -((8 - p) / 9); }
+
+static int npf_exact_msd(uint32_t const *l, int a, int z, int r) {
+  int n = 0;
+  if (a >= z) { return 0; }
+  while ((n < 8) && (l[a] >= npf_exact_pow10[n + 1])) { ++n; }
+  return 9 * (r - 1 - a) + n;
+}
+
+/* Expands and rounds f into the arena and returns the length of the output, sign
+   excluded, or 0 when the conversion isn't for this engine and ex->l is NULL. */
+static NPF_NOINLINE int npf_exact_prep(
+    npf_exact_t *ex, npf_format_spec_t const *spec, npf_real_t f) {
+  uint32_t *const l = npf_exact_arena;
+  npf_real_bin_t bin = npf_real_to_int_rep(f);
+  int e = (int)((bin >> NPF_REAL_MAN_BITS) & NPF_REAL_EXP_MASK);
+  int prec = NPF_DEC_PREC(spec), nsig = 0, a, z, r, k, q;
+  uint32_t sticky = 0;
+  char style = 'f', strip = 0, alt = 0;
+
+  ex->l = NULL;
+  if (!l || (e == NPF_REAL_EXP_MASK)) { return 0; } // not installed, or inf / nan
+#if NANOPRINTF_USE_FLOAT_HEX_FORMAT_SPECIFIER == 1
+  if (spec->conv_spec == NPF_FMT_SPEC_CONV_FLOAT_HEX) { return 0; } // already exact
+#endif
+#if NANOPRINTF_USE_ALT_FORM_FLAG == 1
+  alt = (char)spec->alt_form;
+#endif
+#if NANOPRINTF_USE_FLOAT_SCI_FORMAT_SPECIFIER == 1
+  if (spec->conv_spec == NPF_FMT_SPEC_CONV_FLOAT_SCI) { style = 'e'; nsig = prec + 1; }
+#endif
+#if NANOPRINTF_USE_FLOAT_SHORTEST_FORMAT_SPECIFIER == 1
+  if (spec->conv_spec == NPF_FMT_SPEC_CONV_FLOAT_SHORTEST) {
+    style = 'g';
+    nsig = prec ? prec : 1;
+    strip = !alt;
+  }
+#endif
+
+  bin &= ((npf_real_bin_t)0x1 << NPF_REAL_MAN_BITS) - 1;
+  if (e) { bin |= (npf_real_bin_t)0x1 << NPF_REAL_MAN_BITS; } else { ++e; }
+  e -= NPF_REAL_EXP_BIAS + NPF_REAL_MAN_BITS; // f is bin * 2^e
+
+  { // Where the guard digit is, one below the last digit kept.
+    int fl, qg = -prec - 1;
+    if (style != 'f') {
+      // floor(log10(2) * msb) - 1 is at or below the leading digit's position.
+      long t = e;
+      for (npf_real_bin_t b = bin; b >>= 1;) { ++t; }
+      t *= 1233; // 1233 / 4096 is just under log10(2)
+      qg = (int)((t >= 0) ? (t >> 12) : -((4095 - t) >> 12)) - 1 - nsig;
+    }
+    r = (e >= 0) ? NPF_EXACT_LIMBS : 3; // l[0] takes a carry out of the top digit
+    fl = (qg < 0) ? ((8 - qg) / 9) : 0; // fraction limbs the conversion can see
+    if (fl > NPF_EXACT_LIMBS - r) { fl = NPF_EXACT_LIMBS - r; }
+
+    a = z = r;
+    while (bin) { l[--a] = (uint32_t)(bin % 1000000000u); bin /= 1000000000u; }
+
+    while (e > 0) {
+      int const sh = (e < 29) ? e : 29;
+      uint_fast64_t c = 0;
+      e -= sh;
+      for (k = z; k-- > a;) {
+        c += (uint_fast64_t)l[k] << sh;
+        l[k] = (uint32_t)(c % 1000000000u);
+        c /= 1000000000u;
+      }
+      if (c) { l[--a] = (uint32_t)c; }
+    }
+
+    while (e < 0) {
+      int const sh = (e > -9) ? -e : 9;
+      uint32_t const mask = (uint32_t)((1u << sh) - 1u), mul = 1000000000u >> sh;
+      uint32_t c = 0;
+      e += sh;
+      for (k = a; k < z; ++k) {
+        uint32_t const v = l[k];
+        l[k] = (v >> sh) + c;
+        c = (v & mask) * mul;
+      }
+      if (c) {
+        if (z < r + fl) { l[z++] = c; } else { sticky = 1; }
+      }
+      while ((a < z) && !l[a]) { ++a; }
+    }
+  }
+
+  // Round at q, the position of the last digit kept.
+  q = -prec;
+  if (style != 'f') { q = npf_exact_msd(l, a, z, r) - nsig + 1; }
+  k = r - 1 - npf_exact_div9(q);
+  if (k < z) {
+    int const j = q - 9 * npf_exact_div9(q);
+    uint32_t unit = npf_exact_pow10[j], rem, half = unit / 2;
+    int i = k + 1;
+    if (k < a) { for (int n = k; n < a; ++n) { l[n] = 0; } a = k; }
+    rem = l[k] % unit;
+    l[k] -= rem;
+    if (!j) { rem = (i < z) ? l[i++] : 0; half = 500000000u; } // the guard is the next limb
+    for (; !sticky && (i < z); ++i) { sticky = l[i]; }
+    z = k + 1;
+    if ((rem > half) || ((rem == half) && (sticky || ((l[k] / unit) & 1)))) {
+      while ((l[k] += unit) >= 1000000000u) { // 999.. carries, possibly into l[0]
+        l[k] = 0;
+        unit = 1;
+        if (--k < a) { l[k] = 0; a = k; }
+      }
+    }
+    while ((a < z) && !l[a]) { ++a; }
+  }
+
+  ex->l = l;
+  ex->a = a;
+  ex->z = z;
+  ex->r = r;
+  ex->x = npf_exact_msd(l, a, z, r); // after rounding, which can add a digit
+  ex->e_char = 0;
+  if (style != 'f') {
+    int lz = ex->x; // the lowest nonzero digit, for %g's stripping
+    for (k = z; k-- > a;) {
+      if (l[k]) {
+        uint32_t v = l[k];
+        for (lz = 9 * (r - 1 - k); !(v % 10); v /= 10) { ++lz; }
+        break;
+      }
+    }
+    prec = nsig - 1;
+    if ((style == 'e') || (ex->x < -4) || (ex->x >= nsig)) {
+      ex->e_char = (char)('E' + spec->case_adjust);
+      if (strip) { prec = ex->x - lz; }
+    } else { // C11 7.21.6.1p8: 'g' in style 'f' keeps the same significant digits
+      prec = nsig - 1 - ex->x;
+      if (strip) { prec = (lz < 0) ? -lz : 0; }
+    }
+  }
+  ex->prec = prec;
+  ex->dot = (char)((prec > 0) || alt);
+
+  if (ex->e_char) {
+    int const ax = (ex->x < 0) ? -ex->x : ex->x;
+    return 1 + ex->dot + prec + 2 + ((ax >= 100) ? 3 : 2);
+  }
+  return ((ex->x > 0) ? ex->x + 1 : 1) + ex->dot + prec;
+}
+
+// Emits the digits at decimal positions hi down to lo, decoding a limb at a time.
+static void npf_exact_digits(
+    npf_exact_t const *ex, npf_putc pc, void *pc_ctx, int hi, int lo) {
+  while (hi >= lo) {
+    int const d9 = npf_exact_div9(hi), k = ex->r - 1 - d9;
+    uint32_t v = ((k >= ex->a) && (k < ex->z)) ? ex->l[k] : 0;
+    char d[9];
+    for (int i = 0; i < 9; ++i) { d[i] = (char)('0' + (char)(v % 10)); v /= 10; }
+    for (int j = hi - (9 * d9); (j >= 0) && (hi >= lo); --j, --hi) { pc(d[j], pc_ctx); }
+  }
+}
+
+static NPF_NOINLINE void npf_exact_put(npf_exact_t const *ex, npf_putc pc, void *pc_ctx) {
+  int const x = ex->x;
+  if (!ex->e_char) {
+    npf_exact_digits(ex, pc, pc_ctx, (x > 0) ? x : 0, 0);
+    if (ex->dot) { pc('.', pc_ctx); }
+    npf_exact_digits(ex, pc, pc_ctx, -1, -ex->prec);
+    return;
+  }
+  npf_exact_digits(ex, pc, pc_ctx, x, x);
+  if (ex->dot) { pc('.', pc_ctx); }
+  npf_exact_digits(ex, pc, pc_ctx, x - 1, x - ex->prec);
+  pc(ex->e_char, pc_ctx);
+  pc((x < 0) ? '-' : '+', pc_ctx);
+  { // At least two digits, and no binary exponent reaches 1000 decimal ones.
+    int const ax = (x < 0) ? -x : x;
+    if (ax >= 100) { pc('0' + (ax / 100), pc_ctx); }
+    pc('0' + ((ax / 10) % 10), pc_ctx);
+    pc('0' + (ax % 10), pc_ctx);
+  }
+}
+#endif // NANOPRINTF_USE_FLOAT_EXACT
+
+#if NANOPRINTF_USE_FLOAT_HEX_FORMAT_SPECIFIER == 1
+
+// Hex float always operates on IEEE 754 binary64 (double) bits.
+// When not in single-precision mode, npf_real_* already handles double; in it, the
+// float's bits are widened in integer arithmetic.
+#if NANOPRINTF_USE_FLOAT_SINGLE_PRECISION == 1
+typedef uint_fast64_t npf_double_bin_t;
+enum {
+  NPF_DOUBLE_EXP_MASK = 2047,
+  NPF_DOUBLE_EXP_BIAS = 1023,
+  NPF_DOUBLE_MAN_BITS = 52,
+};
+#define npf_double_to_int_rep(f) npf_bits32_to_bits64(npf_real_to_int_rep(f))
+#else
+typedef npf_real_bin_t npf_double_bin_t;
+#define NPF_DOUBLE_EXP_MASK NPF_REAL_EXP_MASK
+#define NPF_DOUBLE_EXP_BIAS NPF_REAL_EXP_BIAS
+#define NPF_DOUBLE_MAN_BITS NPF_REAL_MAN_BITS
+#define npf_double_to_int_rep(f) npf_real_to_int_rep(f)
+#endif
+
+static NPF_NOINLINE int npf_atoa_rev(
+    char *buf, npf_format_spec_t const *spec, npf_double_bin_t bin) {
+  npf_ftoa_exp_t exp =
+    (npf_ftoa_exp_t)((npf_ftoa_exp_t)(bin >> NPF_DOUBLE_MAN_BITS) & NPF_DOUBLE_EXP_MASK);
+  bin &= ((npf_double_bin_t)0x1 << NPF_DOUBLE_MAN_BITS) - 1;
+
   if (exp == (npf_ftoa_exp_t)NPF_DOUBLE_EXP_MASK) { return 0; } // caller uses ftoa_rev
 
   if (exp) {
@@ -1637,6 +3125,422 @@ static int npf_bin_len(npf_uint_t u) {
 }
 #endif
 
+#if NPF_USE_QTOA == 1
+/* Lays out a reversed fixed-point payload in place. buf holds n reversed digits of
+   an integer that carries z fewer fraction digits than prec asks for; they move up
+   past z appended zeros and the point, and zeros fill in up to one integer digit.
+   Returns the length, or -1 when that doesn't fit. */
+static int npf_fixed_layout(char *buf, int n, int z, int prec, int dot) {
+  int const ndig = NPF_MAX(n + z, prec + 1);
+  if (ndig + dot > NPF_CBUF) { return -1; }
+  for (int d = ndig; d-- > 0;) { // top down: every source is at or below its target
+    buf[d + ((d >= prec) ? dot : 0)] = ((d >= z) && ((d - z) < n)) ? buf[d - z] : '0';
+  }
+  if (dot) { buf[prec] = '.'; }
+  return ndig + dot;
+}
+
+// Adds one unit in the last place to a reversed payload of len, stepping over the
+// point. Returns the new length, or -1 when a carry out of the top doesn't fit.
+static int npf_fixed_round_up(char *buf, int len) {
+  for (int i = 0; i < len; ++i) {
+    if (buf[i] == '.') { continue; }
+    if (buf[i] != '9') { ++buf[i]; return len; }
+    buf[i] = '0';
+  }
+  if (len >= NPF_CBUF) { return -1; }
+  buf[len] = '1';
+  return len + 1;
+}
+
+/* %k: m is a magnitude with scale fraction bits. %r: m is a magnitude scaled by
+   10^scale. Both round to nearest, ties to even, in integer arithmetic only, and
+   write the reversed payload to buf. A negative return is the length of "ERR". */
+static int npf_qtoa_rev(char *buf, npf_format_spec_t const *spec, npf_uint_t m,
+                        int scale) {
+  int const w = (int)(sizeof(npf_uint_t) * CHAR_BIT);
+#if NANOPRINTF_USE_FIXED_POINT_FORMAT_SPECIFIERS == 1
+  uint_fast8_t const dec = (spec->conv_spec == NPF_FMT_SPEC_CONV_FIXED_DEC);
+#else
+  uint_fast8_t const dec = 0; // only npf_htoa_rev calls in
+#endif
+  int prec = dec ? scale : 6, len = -1, dot, n;
+  char r = '0', sticky = 0;
+#if NANOPRINTF_USE_PRECISION_FORMAT_SPECIFIERS == 1
+  if (spec->prec_opt != NPF_FMT_SPEC_OPT_NONE) { prec = spec->prec; }
+#endif
+  if ((scale < 0) || (!dec && (scale > w))) { goto exit; }
+  dot = (prec > 0)
+#if NANOPRINTF_USE_ALT_FORM_FLAG == 1
+    || spec->alt_form
+#endif
+    ;
+
+  if (dec) {
+    // The value's digits are m's digits; drop the ones below the precision.
+    int lo = scale - prec;
+    n = npf_utoa_rev(m, buf, 10, 0);
+    if (lo > 0) {
+      for (int i = 0; (i < lo - 1) && (i < n); ++i) { sticky |= (char)(buf[i] != '0'); }
+      if (lo <= n) { r = buf[lo - 1]; }
+      n = (lo < n) ? (n - lo) : 0;
+      for (int i = 0; i < n; ++i) { buf[i] = buf[i + lo]; }
+      lo = 0;
+    }
+    if ((len = npf_fixed_layout(buf, n, -lo, prec, dot)) < 0) { goto exit; }
+  } else {
+    // Integer digits first, then the fraction, top-aligned so that each digit is
+    // the carry out of a multiply by 10 (as x8 + x2, no wide multiply needed).
+    npf_uint_t f = scale ? (m << (w - scale)) : 0;
+    n = npf_utoa_rev((scale < w) ? (m >> scale) : 0, buf, 10, 0);
+    if ((len = npf_fixed_layout(buf, n, prec, prec, dot)) < 0) { goto exit; }
+    for (int i = prec; i-- > 0;) {
+      npf_uint_t const a = f << 3, lo = a + (f << 1);
+      buf[i] = (char)('0' + (f >> (w - 3)) + (f >> (w - 1)) + (lo < a));
+      f = lo;
+    }
+    // The first dropped digit and whether anything follows it, from the remainder.
+    npf_uint_t const half = (npf_uint_t)1 << (w - 1);
+    r = (f > half) ? '6' : (f == half) ? '5' : '0';
+  }
+
+  if ((r > '5') || ((r == '5') && (sticky || (buf[buf[0] == '.'] & 1)))) {
+    len = npf_fixed_round_up(buf, len);
+  }
+
+exit:
+  if (len < 0) { // reversed "ERR", negated: text rather than a number
+    buf[0] = buf[1] = (char)('R' + spec->case_adjust);
+    buf[2] = (char)('E' + spec->case_adjust);
+    len = -3;
+  }
+  return len;
+}
+#endif
+
+#if NANOPRINTF_USE_FLOAT_HALF_FORMAT_SPECIFIERS == 1
+/* %f of finite binary16 bits. Every one is m / 2^s with an 11-bit m and s <= 24,
+   or an integer below 2^16, so npf_qtoa_rev prints it exactly in 32 bits. */
+static int npf_htoa_rev(char *buf, npf_format_spec_t const *spec, uint_fast32_t h) {
+  int const e = (int)((h >> 10) & 0x1Fu);
+  npf_uint_t m = h & 0x3FFu;
+  if (e) { m |= 0x400u; }
+  int const s = 25 - (e ? e : 1); // the value is m * 2^-s
+  return (s >= 0) ? npf_qtoa_rev(buf, spec, m, s) : npf_qtoa_rev(buf, spec, m << -s, 0);
+}
+#endif
+
+#if NANOPRINTF_USE_BIGNUM_FORMAT_SPECIFIERS == 1
+/* A limb array converts in scratch on the stack: its value as 32-bit words, and for
+   decimal the base-10^9 chunks that short division by 10^9 peels off them. The
+   digits are emitted from there, so they never have to fit the conversion buffer. */
+#define NPF_BIG_WORDS (NANOPRINTF_BIGNUM_MAX_BITS / 32)
+#define NPF_BIG_CHUNKS ((NANOPRINTF_BIGNUM_MAX_BITS * 1000 / 29897) + 1) // log2(1e9)
+
+typedef struct npf_big {
+  uint32_t w[NPF_BIG_WORDS];  // the value, least significant word first
+  uint32_t c[NPF_BIG_CHUNKS]; // decimal only: base-10^9 chunks, least significant first
+  int n;                      // words of w in use, or chunks of c; -1 when too wide
+  int digits;                 // digits to emit, 0 when no limb array is being printed
+  uint_fast8_t shift;         // bits per digit, 0 for decimal
+  char case_adj;
+  char lead0;                 // '#' octal: one more '0' in front
+} npf_big_t;
+
+// Copies count limbs of 32 or 64 bits into b->w. Returns the words in use.
+static int npf_big_load(npf_big_t *b, int count, void const *limbs, uint_fast8_t wide) {
+  uint32_t const *const l32 = (uint32_t const *)limbs;
+  uint64_t const *const l64 = (uint64_t const *)limbs;
+  int n = 0;
+  if (!limbs) { count = 0; }
+  if (wide) {
+    while ((count > 0) && !l64[count - 1]) { --count; }
+    if (count > (NPF_BIG_WORDS / 2)) { return b->n = -1; }
+    for (int i = 0; i < count; ++i) {
+      b->w[n++] = (uint32_t)l64[i];
+      b->w[n++] = (uint32_t)(l64[i] >> 32);
+    }
+    if (n && !b->w[n - 1]) { --n; }
+  } else {
+    while ((count > 0) && !l32[count - 1]) { --count; }
+    if (count > NPF_BIG_WORDS) { return b->n = -1; }
+    for (; n < count; ++n) { b->w[n] = l32[n]; }
+  }
+  if (!n) { b->w[0] = 0; }
+  return b->n = n;
+}
+
+/* Readies b for npf_big_put with shift bits per digit, or decimal for 0. Returns the
+   digit count, or the negated length of "ERR" written to buf if the value was too
+   wide. Decimal is plain short division: at the sizes a stack buffer holds, the
+   divide-and-conquer split would spend more on its big divisions than it saves. */
+static int npf_big_prep(npf_big_t *b, char *buf, uint_fast8_t shift, char case_adj) {
+  int n = b->n, d;
+  if (n < 0) {
+    buf[0] = buf[1] = (char)('R' + case_adj);
+    buf[2] = (char)('E' + case_adj);
+    return -3;
+  }
+  b->shift = shift;
+  b->case_adj = case_adj;
+  b->lead0 = 0;
+  if (shift) {
+    uint32_t top = n ? b->w[n - 1] : 0;
+    int bits = n ? (32 * (n - 1)) : 0;
+    for (; top; top >>= 1) { ++bits; }
+    d = (bits + shift - 1) / shift;
+  } else {
+    int k = 0;
+    do {
+      uint64_t r = 0; // each step divides 64-bit values by 10^9
+      for (int i = n; i-- > 0;) {
+        uint64_t const cur = (r << 32) | b->w[i];
+        b->w[i] = (uint32_t)(cur / 1000000000u);
+        r = cur % 1000000000u;
+      }
+      b->c[k++] = (uint32_t)r;
+      while (n && !b->w[n - 1]) { --n; }
+    } while (n);
+    b->n = k;
+    d = 9 * (k - 1);
+    for (uint32_t top = b->c[k - 1]; top; top /= 10u) { ++d; }
+  }
+  return b->digits = (d ? d : 1);
+}
+
+static NPF_NOINLINE void npf_big_put(npf_big_t const *b, npf_putc pc, void *pc_ctx) {
+  if (b->lead0) { pc('0', pc_ctx); }
+  if (!b->shift) {
+    for (int i = b->n; i-- > 0;) {
+      char d[9];
+      uint32_t v = b->c[i];
+      int j = 0;
+      // The top chunk prints as it is, every other one as nine digits.
+      do { d[j++] = (char)('0' + (v % 10u)); v /= 10u; } while ((i == b->n - 1) ? v : (j < 9));
+      while (j) { pc(d[--j], pc_ctx); }
+    }
+    return;
+  }
+  uint_fast8_t const s = b->shift;
+  for (int i = b->digits; i-- > 0;) {
+    int const pos = i * s, wi = pos >> 5, bi = pos & 31;
+    uint32_t v = b->w[wi] >> bi;
+    if ((bi + s > 32) && (wi + 1 < b->n)) { v |= b->w[wi + 1] << (32 - bi); } // octal
+    v &= (1u << s) - 1u;
+    pc((v < 10u) ? (int)('0' + v) : (int)('A' - 10 + b->case_adj + (int)v), pc_ctx);
+  }
+}
+#endif
+
+#if NANOPRINTF_USE_HEXDUMP_FORMAT_SPECIFIER == 1
+typedef struct npf_hexdump {
+  unsigned char const *p;
+  int n;     // bytes to dump
+  int line;  // bytes per line
+  char sep;  // ' ' between bytes, or 0
+  char ascii; // '#': an ASCII gutter after each line
+} npf_hexdump_t;
+
+// Characters one line of k bytes takes before its gutter.
+static int npf_hexdump_hex_len(npf_hexdump_t const *d, int k) {
+  return (2 * k) + (d->sep ? (k - 1) : 0);
+}
+
+/* Fills d from the count and pointer; returns the total output length, or -1 for a
+   count too big to dump. That is the digit loop's stop, so a literal count it cut
+   short can't pass as a smaller one, and 8 output bytes per input byte stay in int. */
+static int npf_hexdump_prep(npf_hexdump_t *d, void const *p, int n, int line) {
+  if (!p || (n < 0)) { n = 0; }
+  d->n = 0;
+  if (NPF_FMT_NUM_BIG(n)) { return -1; }
+  d->p = (unsigned char const *)p;
+  d->n = n;
+  d->line = ((line > 0) && (line < n)) ? line : n;
+  if (!n) { return 0; }
+  int const lines = ((n - 1) / d->line) + 1;
+  int const body = d->ascii ? ((lines * (npf_hexdump_hex_len(d, d->line) + 4)) + n)
+                            : ((2 * n) + (d->sep ? (n - lines) : 0));
+  return body + lines - 1;
+}
+
+static NPF_NOINLINE void npf_hexdump_put(npf_hexdump_t const *d, npf_putc pc,
+                                         void *pc_ctx) {
+  unsigned char const *p = d->p;
+  for (int left = d->n; left > 0;) {
+    int const k = NPF_MIN(left, d->line);
+    for (int i = 0; i < k; i += 4) { // four bytes per pass through the nibble kernel
+      int const m = NPF_MIN(4, k - i);
+      uint32_t v = 0;
+      for (int j = 0; j < 4; ++j) { v = (v << 8) | ((j < m) ? p[i + j] : 0u); }
+      uint64_t const x = npf_hex8(v, 0); // the first byte's digits are the top two
+      for (int j = 0; j < m; ++j) {
+        if (d->sep && (i + j)) { pc(d->sep, pc_ctx); }
+        pc((char)(x >> (56 - (16 * j))), pc_ctx);
+        pc((char)(x >> (48 - (16 * j))), pc_ctx);
+      }
+    }
+    if (d->ascii) { // short last line: pad the hex so the gutters line up
+      int pad = npf_hexdump_hex_len(d, d->line) - npf_hexdump_hex_len(d, k) + 2;
+      while (pad-- > 0) { pc(' ', pc_ctx); }
+      pc('|', pc_ctx);
+      for (int j = 0; j < k; ++j) {
+        pc(((p[j] >= 0x20u) && (p[j] < 0x7Fu)) ? p[j] : '.', pc_ctx);
+      }
+      pc('|', pc_ctx);
+    }
+    p += k;
+    left -= k;
+    if (left) { pc('\n', pc_ctx); }
+  }
+}
+#endif
+
+#if NANOPRINTF_USE_ESCAPED_STRING_FORMAT_SPECIFIERS == 1
+#define NPF_SWAR_ONES 0x0101010101010101u
+// Nonzero if any byte of W is zero. Exact for "any", though not for which one.
+#define NPF_SWAR_HAS_ZERO(W) (((W) - NPF_SWAR_ONES) & ~(W) & (NPF_SWAR_ONES * 0x80u))
+#define NPF_SWAR_HAS(W, C) NPF_SWAR_HAS_ZERO((W) ^ (NPF_SWAR_ONES * (unsigned char)(C)))
+
+static int npf_esc_special(char c, char csv) {
+  if (csv) { return (c == ',') || (c == '"') || (c == '\n') || (c == '\r'); }
+  return ((unsigned char)c < 0x20u) || (c == '"') || (c == '\\');
+}
+
+/* Index of the first byte in s[i, len) the dialect has to escape, or len. Whole
+   words are tested eight bytes at a time and skipped when nothing in them matches,
+   so plain text costs a few ALU ops per eight bytes. */
+static int npf_esc_scan(char const *s, int i, int len, char csv) {
+  for (; (len - i) >= 8; i += 8) {
+    // Byte order doesn't matter for "any byte"; compilers fuse this into one load.
+    unsigned char const *const b = (unsigned char const *)s + i;
+    uint64_t const w = (uint64_t)b[0] | ((uint64_t)b[1] << 8) | ((uint64_t)b[2] << 16) |
+      ((uint64_t)b[3] << 24) | ((uint64_t)b[4] << 32) | ((uint64_t)b[5] << 40) |
+      ((uint64_t)b[6] << 48) | ((uint64_t)b[7] << 56);
+    uint64_t const hit = csv ?
+      (NPF_SWAR_HAS(w, ',') | NPF_SWAR_HAS(w, '"') | NPF_SWAR_HAS(w, '\n') |
+       NPF_SWAR_HAS(w, '\r')) :
+      (NPF_SWAR_HAS(w, '"') | NPF_SWAR_HAS(w, '\\') |
+       ((w - (NPF_SWAR_ONES * 0x20u)) & ~w & (NPF_SWAR_ONES * 0x80u))); // any < 0x20
+    if (hit) { break; }
+  }
+  for (; (i < len) && !npf_esc_special(s[i], csv); ++i);
+  return i;
+}
+
+/* Writes s[0, len) escaped, or only counts when pc is NULL; returns the escaped
+   length. JSON escapes '"', '\\' and control characters for a string body; CSV
+   wraps a field holding ',', '"' or a line break in quotes and doubles its '"'s. */
+static int npf_esc_put(char const *s, int len, char csv, npf_putc pc, void *pc_ctx) {
+  int i = 0, n = 0, run = npf_esc_scan(s, 0, len, csv);
+  char const quote = (char)(csv && (run < len));
+  if (quote) { n += 2; if (pc) { pc('"', pc_ctx); } }
+  for (;;) {
+    n += run - i;
+    if (pc) { while (i < run) { pc(s[i++], pc_ctx); } }
+    if (run == len) { break; }
+    char const c = s[run];
+    i = run + 1;
+    if (csv) { // only a '"' changes inside the quotes
+      n += 1 + (c == '"');
+      if (pc) { pc(c, pc_ctx); if (c == '"') { pc(c, pc_ctx); } }
+    } else {
+      char e = (c == '"') ? '"' : (c == '\\') ? '\\' : (c == '\b') ? 'b' : (c == '\f') ? 'f'
+             : (c == '\n') ? 'n' : (c == '\r') ? 'r' : (c == '\t') ? 't' : 0;
+      n += e ? 2 : 6;
+      if (pc) {
+        pc('\\', pc_ctx);
+        if (e) { pc(e, pc_ctx); } else {
+          e = (char)(c >> 4);
+          pc('u', pc_ctx); pc('0', pc_ctx); pc('0', pc_ctx); pc('0' + e, pc_ctx);
+          e = (char)(c & 0xF);
+          pc((e < 10) ? ('0' + e) : ('a' - 10 + e), pc_ctx);
+        }
+      }
+    }
+    run = npf_esc_scan(s, i, len, csv);
+  }
+  if (quote && pc) { pc('"', pc_ctx); }
+  return n;
+}
+#endif
+
+#if NANOPRINTF_USE_TIMESTAMP_FORMAT_SPECIFIER == 1
+// Writes the low n decimal digits of v, zero-filled, to end the byte before end.
+static void npf_ts_digits(char *end, unsigned long v, int n) {
+  while (n--) { *--end = (char)('0' + (v % 10u)); v /= 10u; }
+}
+
+// Renders the text before the fraction from scratch: the seconds, or date and time.
+static void npf_ts_full(npf_timestamp_t *ts, char iso) {
+  unsigned long const s = ts->sec;
+  char *const t = ts->text;
+  if (iso) { // days since 1970-01-01 to a proleptic Gregorian date, in March-based years
+    unsigned long const z = (s / 86400u) + 719468u, era = z / 146097u;
+    unsigned long const doe = z - (era * 146097u);
+    unsigned long const yoe = (doe - (doe / 1460u) + (doe / 36524u) - (doe / 146096u)) / 365u;
+    unsigned long const doy = doe - ((365u * yoe) + (yoe / 4u) - (yoe / 100u));
+    unsigned long const mp = ((5u * doy) + 2u) / 153u, m = (mp < 10u) ? (mp + 3u) : (mp - 9u);
+    unsigned long const sod = s % 86400u;
+    npf_ts_digits(t + 4, yoe + (era * 400u) + (m <= 2u), 4);
+    npf_ts_digits(t + 7, m, 2);
+    npf_ts_digits(t + 10, doy - (((153u * mp) + 2u) / 5u) + 1u, 2);
+    npf_ts_digits(t + 13, sod / 3600u, 2);
+    npf_ts_digits(t + 16, (sod / 60u) % 60u, 2);
+    npf_ts_digits(t + 19, sod % 60u, 2);
+    t[4] = t[7] = '-'; t[10] = 'T'; t[13] = t[16] = ':';
+    ts->len = 19;
+  } else {
+    int n = 1;
+    for (unsigned long v = s; v >= 10u; v /= 10u) { ++n; }
+    npf_ts_digits(t + n, s, n);
+    ts->len = (unsigned char)n;
+  }
+}
+
+/* Brings the cached text up to ts->sec and ts->usec and returns it. Time moving
+   forward within the day only rewrites the digits that changed: the seconds form
+   adds the difference into its digits in place, and ISO 8601 leaves the date alone.
+   The fraction is always rewritten, since it changes on nearly every call. */
+static char *npf_ts_render(npf_timestamp_t *ts, char iso, int frac, int *len) {
+  unsigned long const s = ts->sec, was = ts->cached_sec;
+  char *const t = ts->text;
+  if (!ts->len || (ts->iso != iso) || (s < was) || (iso && ((s / 86400u) != (was / 86400u)))) {
+    npf_ts_full(ts, iso);
+  } else if (s != was) {
+    if (iso) {
+      unsigned long const sod = s % 86400u;
+      if ((s / 60u) != (was / 60u)) {
+        npf_ts_digits(t + 13, sod / 3600u, 2);
+        npf_ts_digits(t + 16, (sod / 60u) % 60u, 2);
+      }
+      npf_ts_digits(t + 19, sod % 60u, 2);
+    } else {
+      unsigned long d = s - was;
+      unsigned carry = 0;
+      for (int i = ts->len; (d || carry) && (i > 0); d /= 10u) {
+        unsigned const v = (unsigned)(t[--i] - '0') + (unsigned)(d % 10u) + carry;
+        carry = (v >= 10u);
+        t[i] = (char)('0' + (carry ? (v - 10u) : v));
+      }
+      if (d || carry) { npf_ts_full(ts, iso); } // it grew a digit
+    }
+  }
+  ts->cached_sec = s;
+  ts->iso = iso;
+  int n = ts->len;
+  if (frac) {
+    unsigned long u = (ts->usec < 1000000u) ? ts->usec : 999999u;
+    for (int i = frac; i < 6; ++i) { u /= 10u; }
+    t[n] = '.';
+    npf_ts_digits(t + n + 1 + frac, u, frac);
+    n += 1 + frac;
+  }
+  if (iso) { t[n++] = 'Z'; }
+  *len = n;
+  return t;
+}
+#endif
+
 static void npf_bufputc(int c, void *ctx) {
   npf_bufputc_ctx_t *bpc = (npf_bufputc_ctx_t *)ctx;
   // NULL dst -> count-only mode (size-query semantics).
@@ -1689,6 +3593,129 @@ static void npf_bufputc(int c, void *ctx) {
   #define NPF_LM_T_OWN 1
 #endif
 
+#if NANOPRINTF_USE_ARRAY_FORMAT_SPECIFIERS == 1
+typedef struct npf_array {
+  void const *p;   // the next element
+  char const *sep; // printed between elements; NULL prints nothing
+  int n;           // elements not yet read
+} npf_array_t;
+
+// Returns the next element and steps past its size bytes.
+static void const *npf_array_next(npf_array_t *a, size_t size) {
+  void const *const e = a->p;
+  a->p = (unsigned char const *)e + size;
+  --a->n;
+  return e;
+}
+
+#define NPF_ARRAY_INT(MOD, S, U) \
+  case NPF_FMT_SPEC_LEN_MOD_##MOD: \
+    e = npf_array_next(a, sizeof(S)); \
+    return sgn ? (npf_uint_t)(npf_int_t)*(S const *)e : (npf_uint_t)*(U const *)e
+
+/* An integer element. The length modifier sizes it, as it would size the vararg,
+   but nothing was promoted: a 'h' array steps two bytes at a time. Signed elements
+   come back sign-extended, for the caller to cast back. */
+static npf_uint_t npf_array_int(npf_array_t *a, uint_fast8_t lm, uint_fast8_t sgn) {
+  void const *e;
+  switch (lm) {
+#if NANOPRINTF_USE_SMALL_FORMAT_SPECIFIERS == 1
+    NPF_ARRAY_INT(CHAR, signed char, unsigned char);
+    NPF_ARRAY_INT(SHORT, short, unsigned short);
+#endif
+    NPF_ARRAY_INT(LONG, long, unsigned long);
+#if NANOPRINTF_USE_LARGE_FORMAT_SPECIFIERS == 1
+    NPF_ARRAY_INT(LARGE_LONG_LONG, long long, unsigned long long);
+    NPF_ARRAY_INT(LARGE_INTMAX, intmax_t, uintmax_t);
+    NPF_ARRAY_INT(LARGE_SIZET, npf_ssize_t, size_t);
+    NPF_ARRAY_INT(LARGE_PTRDIFFT, ptrdiff_t, npf_uptrdiff_t);
+#endif
+    default: break;
+  }
+  e = npf_array_next(a, sizeof(int));
+  return sgn ? (npf_uint_t)(npf_int_t)*(int const *)e : (npf_uint_t)*(unsigned const *)e;
+}
+#undef NPF_ARRAY_INT
+
+// Any other argument: the array's next T, or the next vararg, promoted to P.
+#define NPF_ARG(T, P) \
+  (arr.n ? *(T const *)npf_array_next(&arr, sizeof(T)) : (T)va_arg(args, P))
+#else
+#define NPF_ARG(T, P) ((T)va_arg(args, P))
+#endif
+
+#if NANOPRINTF_USE_CUSTOM_FORMAT_SPECIFIERS == 1
+int npf_custom_register(char letter, int arg_kind, npf_custom_fn fn) {
+  unsigned const idx = (unsigned)((letter | 32) - 'a');
+  if ((idx >= 24u) || (arg_kind < NPF_CUSTOM_ARG_INT) || (arg_kind > NPF_CUSTOM_ARG_PTR)) {
+    return 0;
+  }
+  // The length modifier letters of this build never reach the conversion lookup.
+  static char const mods[] = "l"
+#if NANOPRINTF_USE_SMALL_FORMAT_SPECIFIERS == 1
+    "h"
+#endif
+#if NANOPRINTF_USE_LARGE_FORMAT_SPECIFIERS == 1
+    "jt"
+#endif
+#if NANOPRINTF_USE_ARRAY_FORMAT_SPECIFIERS == 1
+    "v"
+#endif
+#if (NANOPRINTF_USE_FIXED_WIDTH_FORMAT_SPECIFIERS == 1) || \
+    (NANOPRINTF_USE_BIGNUM_FORMAT_SPECIFIERS == 1)
+    "w" // 'w' and 'W'
+#endif
+    ;
+  for (char const *m = mods; *m; ++m) {
+    if ((letter | 32) == *m) { return 0; }
+  }
+  if (npf_conv_lookup[idx]) { return 0; } // a built-in conversion
+  npf_custom_slots[idx].fn = fn;
+  npf_custom_slots[idx].arg_kind = (uint8_t)arg_kind;
+  return 1;
+}
+#endif
+
+#if NANOPRINTF_USE_PROFILE_HOOKS == 1
+static npf_profile_hooks_t const *npf_profile_hooks;
+
+void npf_profile_install(npf_profile_hooks_t const *hooks) { npf_profile_hooks = hooks; }
+
+static NPF_NOINLINE void npf_profile_begin(npf_profile_event_t *ev, char const *spec,
+                                           char const *end, uint8_t length_modifier) {
+  npf_profile_hooks_t const *const h = npf_profile_hooks;
+  ev->spec = spec;
+  ev->spec_len = (int)(end - spec);
+  ev->conv_spec = end[-1];
+  ev->length_modifier = length_modifier;
+  ev->cbuf_len = ev->field_pad = ev->prec_pad = 0;
+  ev->start = ev->cycles = 0;
+  if (!h) { return; }
+  if (h->begin) { h->begin(h->ctx, ev); }
+  if (h->clock) { ev->start = h->clock(h->ctx); } // last, so begin isn't timed
+}
+
+static NPF_NOINLINE void npf_profile_end(npf_profile_event_t *ev) {
+  npf_profile_hooks_t const *const h = npf_profile_hooks;
+  if (!h) { return; }
+  if (h->clock) { ev->cycles = h->clock(h->ctx) - ev->start; }
+  if (h->end) { h->end(h->ctx, ev); }
+}
+
+void npf_profile_hist_end(void *hist, npf_profile_event_t const *ev) {
+  npf_profile_hist_row_t *const r =
+    &((npf_profile_hist_t *)hist)->row[NPF_PROFILE_HIST_ROW(ev->conv_spec)];
+  unsigned b = 0;
+  for (unsigned long c = ev->cycles; (c >>= 1) && (b < NPF_PROFILE_HIST_BUCKETS - 1);) {
+    ++b;
+  }
+  ++r->count;
+  r->cycles += ev->cycles;
+  if (ev->cycles > r->max) { r->max = ev->cycles; }
+  ++r->bucket[b];
+}
+#endif
+
 int npf_vpprintf(npf_putc pc, void *pc_ctx, char const *format, va_list args) {
   npf_format_spec_t fs;
   char const *cur = format;
@@ -1698,6 +3725,10 @@ int npf_vpprintf(npf_putc pc, void *pc_ctx, char const *format, va_list args) {
     char const *const fs_end =
       (*cur != '%') ? 0 : npf_parse_format_spec_end(cur, &fs);
     if (!fs_end) { NPF_PUTC(*cur++); continue; }
+#if NANOPRINTF_USE_PROFILE_HOOKS == 1
+    npf_profile_event_t prof;
+    npf_profile_begin(&prof, cur, fs_end, fs.length_modifier);
+#endif
     cur = fs_end;
 
     // Extract star-args immediately
@@ -1718,8 +3749,15 @@ int npf_vpprintf(npf_putc pc, void *pc_ctx, char const *format, va_list args) {
       fs.prec = va_arg(args, int);
       if (fs.prec < 0) { fs.prec_opt = NPF_FMT_SPEC_OPT_NONE; }
     }
+#if NANOPRINTF_USE_HEXDUMP_FORMAT_SPECIFIER == 1
+    // A dump's precision is its byte count, which npf_hexdump_prep bounds itself.
+    if ((fs.prec > NPF_FMT_NUM_MAX) && (fs.conv_spec != NPF_FMT_SPEC_CONV_HEXDUMP)) {
+      fs.prec = NPF_FMT_NUM_MAX;
+    }
+#else
     if (fs.prec > NPF_FMT_NUM_MAX) { fs.prec = NPF_FMT_NUM_MAX; }
 #endif
+#endif
 
 #if NANOPRINTF_USE_PRECISION_FORMAT_SPECIFIERS == 1
   // Set default precision (we can do that only now that we have extracted the
@@ -1756,10 +3794,51 @@ int npf_vpprintf(npf_putc pc, void *pc_ctx, char const *format, va_list args) {
        ) { fs.leading_zero_pad = 0; }
 #endif
 
-    union { char cbuf_mem[NPF_CBUF]; npf_uint_t binval; } u;
-    char *cbuf = u.cbuf_mem, sign_c = 0;
-    int cbuf_len = 0;
+#if NANOPRINTF_USE_ARRAY_FORMAT_SPECIFIERS == 1
+    // The array comes after any star args; every element then starts from fs_elem.
+    npf_array_t arr;
+    arr.n = 0;
+    if (fs.array) {
+      arr.n = va_arg(args, int);
+      arr.p = va_arg(args, void const *);
+      arr.sep = va_arg(args, char const *);
+      if ((arr.n <= 0) || !arr.p) {
+#if NANOPRINTF_USE_PROFILE_HOOKS == 1
+        npf_profile_end(&prof);
+#endif
+        continue;
+      }
+    }
+    npf_format_spec_t const fs_elem = fs;
+npf_array_elem:
+#endif
+    union { char cbuf_mem[NPF_CBUF]; npf_binval_t binval; } u;
+    char *cbuf = u.cbuf_mem, sign_c = 0;
+    int cbuf_len = 0;
     char need_0x = 0;
+#if NANOPRINTF_USE_FLOAT_STREAMING == 1
+    npf_real_t stream_val = 0;
+    char stream = 0;
+#endif
+#if NANOPRINTF_USE_FLOAT_EXACT == 1
+    npf_exact_t exact;
+    exact.l = NULL;
+#endif
+#if NANOPRINTF_USE_BIGNUM_FORMAT_SPECIFIERS == 1
+    npf_big_t big;
+    big.digits = 0;
+#endif
+#if NANOPRINTF_USE_HEXDUMP_FORMAT_SPECIFIER == 1
+    npf_hexdump_t dump;
+#endif
+#if NANOPRINTF_USE_CUSTOM_FORMAT_SPECIFIERS == 1
+    npf_custom_spec_t custom;
+    npf_custom_fn custom_fn = NULL;
+#endif
+#if NANOPRINTF_USE_ESCAPED_STRING_FORMAT_SPECIFIERS == 1
+    char esc = 0;    // 'j' JSON, 'c' CSV
+    int esc_len = 0; // source bytes; cbuf_len is the escaped length
+#endif
 #if NANOPRINTF_USE_FIELD_WIDTH_FORMAT_SPECIFIERS == 1
     int field_pad = 0;
     char pad_c = 0;
@@ -1776,31 +3855,104 @@ int npf_vpprintf(npf_putc pc, void *pc_ctx, char const *format, va_list args) {
 #if NANOPRINTF_USE_FLOAT_FORMAT_SPECIFIERS == 1
     if (fs.conv_spec >= NPF_FMT_SPEC_CONV_FLOAT_DEC) {
       npf_real_t val;
+#if NANOPRINTF_USE_FLOAT_HALF_FORMAT_SPECIFIERS == 1
+      uint_fast32_t half = 0; // binary16 bits for npf_htoa_rev, or 0
+#endif
+#if NANOPRINTF_USE_FLOAT_BITS_FORMAT_SPECIFIERS == 1
+      // The bits go straight into the engines, which only ever look at bits.
+#if NANOPRINTF_USE_FLOAT_SINGLE_PRECISION == 0
+      if (fs.length_modifier == NPF_FMT_SPEC_LEN_MOD_FLOAT_BITS64) {
+        val = npf_real_from_int_rep((npf_real_bin_t)NPF_ARG(uint64_t, uint64_t));
+      } else
+#endif
+      if (fs.length_modifier >= NPF_FMT_SPEC_LEN_MOD_FLOAT_BITS32) {
+        uint_fast32_t b;
+#if NANOPRINTF_USE_FLOAT_HALF_FORMAT_SPECIFIERS == 1
+        // 16-bit arguments arrive promoted to int. bfloat16 is a truncated binary32.
+        if (fs.length_modifier >= NPF_FMT_SPEC_LEN_MOD_FLOAT_HALF) {
+          b = (uint_fast32_t)NPF_ARG(uint16_t, unsigned) & 0xFFFFu;
+          if (fs.length_modifier == NPF_FMT_SPEC_LEN_MOD_FLOAT_HALF) {
+            half = b | 0x10000u; // the marker bit keeps +0 nonzero
+            b = npf_half_to_bits32(b);
+          } else {
+            b <<= 16;
+          }
+        } else
+#endif
+        { b = (uint_fast32_t)NPF_ARG(uint32_t, uint32_t); }
 #if NANOPRINTF_USE_FLOAT_SINGLE_PRECISION == 1
-      val = va_arg(args, npf_float_t).val;
-#elif LDBL_MANT_DIG == DBL_MANT_DIG
-      // long double has the same representation as double
-      // no need to branch on the 'L' length modifier.
-      val = va_arg(args, double);
+        val = npf_real_from_int_rep((npf_real_bin_t)b);
 #else
-      if (fs.length_modifier == NPF_FMT_SPEC_LEN_MOD_LONG_DOUBLE) {
-        val = (npf_real_t)va_arg(args, long double);
-      } else {
+        val = npf_real_from_int_rep(npf_bits32_to_bits64(b));
+#endif
+      } else
+#endif
+#if NANOPRINTF_USE_ARRAY_FORMAT_SPECIFIERS == 1
+      // Nothing promotes an array element: 'h' marks an array of float, 'L' one of
+      // long double, and anything else one of double.
+      if (arr.n) {
+#if NANOPRINTF_USE_SMALL_FORMAT_SPECIFIERS == 1
+        if (fs.length_modifier == NPF_FMT_SPEC_LEN_MOD_SHORT) {
+          val = (npf_real_t)NPF_ARG(float, double);
+        } else
+#endif
+        if (fs.length_modifier == NPF_FMT_SPEC_LEN_MOD_LONG_DOUBLE) {
+          val = (npf_real_t)NPF_ARG(long double, long double);
+        } else {
+          val = (npf_real_t)NPF_ARG(double, double);
+        }
+      } else
+#endif
+      {
+#if NANOPRINTF_USE_FLOAT_SINGLE_PRECISION == 1
+        val = va_arg(args, npf_float_t).val;
+#elif LDBL_MANT_DIG == DBL_MANT_DIG
+        // long double has the same representation as double
+        // no need to branch on the 'L' length modifier.
         val = va_arg(args, double);
-      }
+#else
+        if (fs.length_modifier == NPF_FMT_SPEC_LEN_MOD_LONG_DOUBLE) {
+          val = (npf_real_t)va_arg(args, long double);
+        } else {
+          val = va_arg(args, double);
+        }
 #endif
+      }
 
       sign_c = (npf_real_to_int_rep(val) >> NPF_REAL_SIGN_POS) ? '-' : fs.prepend;
+#if NANOPRINTF_USE_FLOAT_HALF_FORMAT_SPECIFIERS == 1
+      if (half && (fs.conv_spec == NPF_FMT_SPEC_CONV_FLOAT_DEC) &&
+          ((half & 0x7C00u) != 0x7C00u) &&
+          ((cbuf_len = npf_htoa_rev(cbuf, &fs, half)) > 0)) {
+        // Exact digits; inf, nan and payloads past cbuf take the float path.
+      } else
+#endif
+#if NANOPRINTF_USE_FLOAT_EXACT == 1
+      if ((cbuf_len = npf_exact_prep(&exact, &fs, val)) > 0) {
+        // The digits stay in the arena; npf_exact_put emits them below.
+      } else
+#endif
 #if NANOPRINTF_USE_FLOAT_HEX_FORMAT_SPECIFIER == 1
       if ((fs.conv_spec == NPF_FMT_SPEC_CONV_FLOAT_HEX) &&
-          ((cbuf_len = npf_atoa_rev(cbuf, &fs, (double)val)) > 0)) {
+          ((cbuf_len = npf_atoa_rev(cbuf, &fs, npf_double_to_int_rep(val))) > 0)) {
         need_0x = (char)('X' + fs.case_adjust);
       } else
 #endif
-#if NPF_USE_SCI == 1
+#if NPF_USE_ETOA == 1
       { cbuf_len = npf_etoa_rev(cbuf, &fs, val); }
 #else
       { cbuf_len = npf_ftoa_rev(cbuf, &fs, NPF_DEC_PREC(&fs), val); }
+#endif
+#if NANOPRINTF_USE_FLOAT_STREAMING == 1
+      // A finite %f that came back as text outgrew cbuf; count it for the padding
+      // now and stream it where the payload goes.
+      if ((cbuf_len < 0) && (fs.conv_spec == NPF_FMT_SPEC_CONV_FLOAT_DEC) &&
+          (((npf_real_to_int_rep(val) >> NPF_REAL_MAN_BITS) & NPF_REAL_EXP_MASK) !=
+           NPF_REAL_EXP_MASK)) {
+        stream_val = val;
+        stream = 1;
+        cbuf_len = npf_ftoa_stream(NULL, NULL, &fs, NPF_DEC_PREC(&fs), val);
+      }
 #endif
       if (cbuf_len < 0) { // negative means text (not number), so ignore the '0' flag
          cbuf_len = -cbuf_len;
@@ -1835,6 +3987,9 @@ int npf_vpprintf(npf_putc pc, void *pc_ctx, char const *format, va_list args) {
   #if NPF_LM_T_OWN
         case NPF_FMT_SPEC_LEN_MOD_LARGE_PTRDIFFT: *(ptrdiff_t *)wb = (ptrdiff_t)npf_n; break;
   #endif
+#endif
+#if NANOPRINTF_USE_INT128_FORMAT_SPECIFIERS == 1
+        case NPF_FMT_SPEC_LEN_MOD_INT128: *(npf_i128_t *)wb = (npf_i128_t)npf_n; break;
 #endif
         default: break;
       }
@@ -1843,9 +3998,52 @@ int npf_vpprintf(npf_putc pc, void *pc_ctx, char const *format, va_list args) {
     if (fs.conv_spec >= NPF_FMT_SPEC_CONV_SIGNED_INT) {
       npf_uint_t val;
       uint_fast8_t base = 10u;
-
-      if (fs.conv_spec == NPF_FMT_SPEC_CONV_SIGNED_INT) {
+#if NANOPRINTF_USE_FIXED_POINT_FORMAT_SPECIFIERS == 1
+      // The scale comes before the value, like a star width. 'k' and 'r' are
+      // signed, 'K' and 'R' unsigned.
+      int scale = 0;
+      uint_fast8_t const fixed = (fs.conv_spec >= NPF_FMT_SPEC_CONV_FIXED_BIN);
+      if (fixed) { scale = va_arg(args, int); }
+#endif
+#if NANOPRINTF_USE_INT128_FORMAT_SPECIFIERS == 1
+      // val only stands in for the 128-bit value's zero tests below.
+      npf_u128_t wide = 0;
+      if (fs.length_modifier == NPF_FMT_SPEC_LEN_MOD_INT128) {
+        if (fs.conv_spec == NPF_FMT_SPEC_CONV_SIGNED_INT) {
+          npf_i128_t const sw = NPF_ARG(npf_i128_t, npf_i128_t);
+          sign_c = (sw < 0) ? '-' : fs.prepend;
+          wide = (npf_u128_t)sw;
+          if (sw < 0) { wide = 0 - wide; }
+        } else {
+          wide = NPF_ARG(npf_u128_t, npf_u128_t);
+          if (fs.conv_spec == NPF_FMT_SPEC_CONV_OCTAL) { base = 8u; }
+          else if (fs.conv_spec == NPF_FMT_SPEC_CONV_HEX_INT) { base = 16u; }
+        }
+        val = (wide != 0);
+      } else
+#endif
+#if NANOPRINTF_USE_BIGNUM_FORMAT_SPECIFIERS == 1
+      // The count comes before the pointer, like a star width before its value.
+      if ((fs.length_modifier == NPF_FMT_SPEC_LEN_MOD_BIG32) ||
+          (fs.length_modifier == NPF_FMT_SPEC_LEN_MOD_BIG64)) {
+        int const count = va_arg(args, int);
+        void const *const limbs = va_arg(args, void const *);
+        if (fs.conv_spec == NPF_FMT_SPEC_CONV_SIGNED_INT) { sign_c = fs.prepend; }
+        else if (fs.conv_spec == NPF_FMT_SPEC_CONV_OCTAL) { base = 8u; }
+        else if (fs.conv_spec == NPF_FMT_SPEC_CONV_HEX_INT) { base = 16u; }
+        val = (npf_big_load(&big, count, limbs,
+                            fs.length_modifier == NPF_FMT_SPEC_LEN_MOD_BIG64) != 0);
+      } else
+#endif
+      if ((fs.conv_spec == NPF_FMT_SPEC_CONV_SIGNED_INT)
+#if NANOPRINTF_USE_FIXED_POINT_FORMAT_SPECIFIERS == 1
+          || (fixed && fs.case_adjust)
+#endif
+         ) {
         npf_int_t sval = 0;
+#if NANOPRINTF_USE_ARRAY_FORMAT_SPECIFIERS == 1
+        if (arr.n) { sval = (npf_int_t)npf_array_int(&arr, fs.length_modifier, 1); } else
+#endif
 #if !NPF_LONG_IS_INT || NANOPRINTF_USE_LARGE_FORMAT_SPECIFIERS == 1
         switch (fs.length_modifier) {
 #if !NPF_LONG_IS_INT
@@ -1884,9 +4082,12 @@ int npf_vpprintf(npf_putc pc, void *pc_ctx, char const *format, va_list args) {
         if (sval < 0) { val = 0 - val; }
       } else {
         if (fs.conv_spec == NPF_FMT_SPEC_CONV_POINTER) {
-          val = (npf_uint_t)(uintptr_t)va_arg(args, void *);
+          val = (npf_uint_t)(uintptr_t)NPF_ARG(void *, void *);
           base = 16u;
         } else {
+#if NANOPRINTF_USE_ARRAY_FORMAT_SPECIFIERS == 1
+          if (arr.n) { val = npf_array_int(&arr, fs.length_modifier, 0); } else
+#endif
 #if !NPF_LONG_IS_INT || NANOPRINTF_USE_LARGE_FORMAT_SPECIFIERS == 1
           switch (fs.length_modifier) {
 #if !NPF_LONG_IS_INT
@@ -1925,18 +4126,58 @@ int npf_vpprintf(npf_putc pc, void *pc_ctx, char const *format, va_list args) {
         }
       }
 
-#if NANOPRINTF_USE_PRECISION_FORMAT_SPECIFIERS == 1
+#if NANOPRINTF_USE_FIXED_POINT_FORMAT_SPECIFIERS == 1
+      if (fixed) {
+        cbuf_len = npf_qtoa_rev(cbuf, &fs, val, scale);
+        if (cbuf_len < 0) { // negative means text (not number), so ignore the '0' flag
+          cbuf_len = -cbuf_len;
 #if NANOPRINTF_USE_FIELD_WIDTH_FORMAT_SPECIFIERS == 1
-      zero = !val;
+          fs.leading_zero_pad = 0;
+#endif
+        }
+      } else
 #endif
+#if NANOPRINTF_USE_PRECISION_FORMAT_SPECIFIERS == 1
       if (!val && (fs.prec_opt != NPF_FMT_SPEC_OPT_NONE) && !fs.prec) {
         // cbuf_len was initialized to 0; preserved here.
+#if NANOPRINTF_USE_FIELD_WIDTH_FORMAT_SPECIFIERS == 1
+        zero = 1;
+#endif
 #if NANOPRINTF_USE_ALT_FORM_FLAG == 1
         if (base == 8u && fs.alt_form) { fs.prec = 1; } // octal '#' special
 #endif
       } else
 #endif
       {
+#if NANOPRINTF_USE_BIGNUM_FORMAT_SPECIFIERS == 1
+        if ((fs.length_modifier == NPF_FMT_SPEC_LEN_MOD_BIG32) ||
+            (fs.length_modifier == NPF_FMT_SPEC_LEN_MOD_BIG64)) {
+          uint_fast8_t shift = (base == 16u) ? 4u : (base == 8u) ? 3u : 0u;
+#if NANOPRINTF_USE_BINARY_FORMAT_SPECIFIERS == 1
+          if (fs.conv_spec == NPF_FMT_SPEC_CONV_BINARY) { shift = 1u; }
+#endif
+          cbuf_len = npf_big_prep(&big, cbuf, shift, fs.case_adjust);
+          if (cbuf_len < 0) { // negative means text (not number), so ignore the '0' flag
+            cbuf_len = -cbuf_len;
+            val = 0; // and '#'
+#if NANOPRINTF_USE_FIELD_WIDTH_FORMAT_SPECIFIERS == 1
+            fs.leading_zero_pad = 0;
+#endif
+          }
+        } else
+#endif
+#if NANOPRINTF_USE_INT128_FORMAT_SPECIFIERS == 1
+        if (fs.length_modifier == NPF_FMT_SPEC_LEN_MOD_INT128) {
+#if NANOPRINTF_USE_BINARY_FORMAT_SPECIFIERS == 1
+          if (fs.conv_spec == NPF_FMT_SPEC_CONV_BINARY) {
+            npf_uint_t const hi = (npf_uint_t)(wide >> 64);
+            cbuf_len = hi ? (64 + npf_bin_len(hi)) : npf_bin_len((npf_uint_t)wide);
+            u.binval = wide;
+          } else
+#endif
+          { cbuf_len = npf_u128toa_rev(wide, cbuf, base, fs.case_adjust); }
+        } else
+#endif
 #if NANOPRINTF_USE_BINARY_FORMAT_SPECIFIERS == 1
         if (fs.conv_spec == NPF_FMT_SPEC_CONV_BINARY) {
           cbuf_len = npf_bin_len(val); u.binval = val;
@@ -1947,7 +4188,11 @@ int npf_vpprintf(npf_putc pc, void *pc_ctx, char const *format, va_list args) {
 #if NANOPRINTF_USE_ALT_FORM_FLAG == 1
         if (val && fs.alt_form) {
           if (base == 8u) {
-            cbuf[cbuf_len++] = '0';
+#if NANOPRINTF_USE_BIGNUM_FORMAT_SPECIFIERS == 1
+            if (big.digits) { big.lead0 = 1; } else
+#endif
+            { cbuf[cbuf_len] = '0'; }
+            ++cbuf_len;
           } else if (base == 16u) {
             need_0x = (char)('X' + fs.case_adjust);
           }
@@ -1959,18 +4204,101 @@ int npf_vpprintf(npf_putc pc, void *pc_ctx, char const *format, va_list args) {
         }
 #endif
       }
-    } else if (fs.conv_spec == NPF_FMT_SPEC_CONV_STRING) {
-      cbuf = va_arg(args, char *);
+    } else
+#if NANOPRINTF_USE_HEXDUMP_FORMAT_SPECIFIER == 1
+    if (fs.conv_spec == NPF_FMT_SPEC_CONV_HEXDUMP) {
+      // The precision is the byte count and the field width the bytes per line,
+      // so neither pads.
+      dump.sep = (fs.prepend == ' ') ? ' ' : 0;
+#if NANOPRINTF_USE_ALT_FORM_FLAG == 1
+      dump.ascii = fs.alt_form;
+#else
+      dump.ascii = 0;
+#endif
+#if NANOPRINTF_USE_FIELD_WIDTH_FORMAT_SPECIFIERS == 1
+      cbuf_len = npf_hexdump_prep(&dump, va_arg(args, void const *), fs.prec,
+                                  fs.field_width);
+      fs.field_width = 0;
+#else
+      cbuf_len = npf_hexdump_prep(&dump, va_arg(args, void const *), fs.prec, 0);
+#endif
+      fs.prec = 0;
+      if (cbuf_len < 0) { // a dump cut short would pass for a whole one
+        cbuf[0] = 'E';
+        cbuf[1] = cbuf[2] = 'R';
+        cbuf_len = 3;
+        fs.conv_spec = NPF_FMT_SPEC_CONV_STRING;
+      }
+    } else
+#endif
+#if NANOPRINTF_USE_TIMESTAMP_FORMAT_SPECIFIER == 1
+    if (fs.conv_spec == NPF_FMT_SPEC_CONV_TIMESTAMP) {
+      npf_timestamp_t *const ts = va_arg(args, npf_timestamp_t *);
+#if NANOPRINTF_USE_PRECISION_FORMAT_SPECIFIERS == 1
+      int const frac = (fs.prec_opt == NPF_FMT_SPEC_OPT_NONE) ? 6 : NPF_MIN(fs.prec, 6);
+#else
+      int const frac = 6;
+#endif
+#if NANOPRINTF_USE_ALT_FORM_FLAG == 1
+      if (ts) { cbuf = npf_ts_render(ts, (char)!!fs.alt_form, frac, &cbuf_len); }
+#else
+      if (ts) { cbuf = npf_ts_render(ts, 0, frac, &cbuf_len); }
+#endif
+      // The cached text goes out as a string: one forward run, width applied.
+      fs.conv_spec = NPF_FMT_SPEC_CONV_STRING;
+    } else
+#endif
+#if NANOPRINTF_USE_CUSTOM_FORMAT_SPECIFIERS == 1
+    if (fs.conv_spec == NPF_FMT_SPEC_CONV_CUSTOM) {
+      struct npf_custom_slot const slot = npf_custom_slots[(fs_end[-1] | 32) - 'a'];
+      custom_fn = slot.fn;
+      if (slot.arg_kind == NPF_CUSTOM_ARG_PTR) {
+        custom.arg.p = NPF_ARG(void const *, void const *);
+      } else if (slot.arg_kind == NPF_CUSTOM_ARG_LONG) {
+        custom.arg.i = NPF_ARG(long, long);
+      } else {
+        custom.arg.i = NPF_ARG(int, int);
+      }
+      custom.conv = fs_end[-1];
+      custom.prepend = fs.prepend;
+#if NANOPRINTF_USE_ALT_FORM_FLAG == 1
+      custom.alt_form = fs.alt_form;
+#else
+      custom.alt_form = 0;
+#endif
+#if NANOPRINTF_USE_PRECISION_FORMAT_SPECIFIERS == 1
+      custom.prec = (fs.prec_opt == NPF_FMT_SPEC_OPT_NONE) ? -1 : fs.prec;
+      fs.prec = 0; // the handler's to interpret, not leading zeros
+#else
+      custom.prec = -1;
+#endif
+#if NANOPRINTF_USE_FIELD_WIDTH_FORMAT_SPECIFIERS == 1
+      // Only a right-justified width needs the length before the bytes.
+      if ((fs.field_width > 0) && !fs.left_justified) {
+        cbuf_len = custom_fn(NULL, NULL, &custom);
+      }
+#endif
+    } else
+#endif
+    if (fs.conv_spec == NPF_FMT_SPEC_CONV_STRING) {
+      cbuf = NPF_ARG(char *, char *);
 #if NANOPRINTF_USE_PRECISION_FORMAT_SPECIFIERS == 1
       for (char const *s = cbuf;
            ((fs.prec_opt == NPF_FMT_SPEC_OPT_NONE) || (cbuf_len < fs.prec)) && cbuf && *s;
            ++s, ++cbuf_len);
 #else
       for (char const *s = cbuf; cbuf && *s; ++s, ++cbuf_len); // strlen
+#endif
+#if NANOPRINTF_USE_ESCAPED_STRING_FORMAT_SPECIFIERS == 1
+      esc = (fs.prepend == '+') ? 'c' : fs.alt_form ? 'j' : 0;
+      if (esc) { // precision limits the source bytes, width pads the escaped ones
+        esc_len = cbuf_len;
+        cbuf_len = npf_esc_put(cbuf, esc_len, esc == 'c', NULL, NULL);
+      }
 #endif
     } else {
       // PERCENT or CHAR: produce a 1-char buffer.
-      *cbuf = (fs.conv_spec == NPF_FMT_SPEC_CONV_CHAR) ? (char)va_arg(args, int) : '%';
+      *cbuf = (fs.conv_spec == NPF_FMT_SPEC_CONV_CHAR) ? NPF_ARG(char, int) : '%';
       cbuf_len = 1;
     }
 
@@ -1993,7 +4321,9 @@ int npf_vpprintf(npf_putc pc, void *pc_ctx, char const *format, va_list args) {
     // after the decimal point; float specs are last in the enum).
 #if NANOPRINTF_USE_PRECISION_FORMAT_SPECIFIERS == 1
     if ((fs.conv_spec != NPF_FMT_SPEC_CONV_STRING)
-#if NANOPRINTF_USE_FLOAT_FORMAT_SPECIFIERS == 1
+#if NANOPRINTF_USE_FIXED_POINT_FORMAT_SPECIFIERS == 1
+        && (fs.conv_spec < NPF_FMT_SPEC_CONV_FIXED_BIN) // fixed point: as FLOAT
+#elif NANOPRINTF_USE_FLOAT_FORMAT_SPECIFIERS == 1
         && (fs.conv_spec < NPF_FMT_SPEC_CONV_FLOAT_DEC)
 #endif
        ) { prec_pad = NPF_MAX(0, fs.prec - cbuf_len); }
@@ -2027,6 +4357,18 @@ int npf_vpprintf(npf_putc pc, void *pc_ctx, char const *format, va_list args) {
       if (need_0x) { NPF_PUT('0'); NPF_PUT(need_0x); need_0x = 0; }
     }
 #endif
+#endif
+#if NANOPRINTF_USE_PROFILE_HOOKS == 1
+    // Capture the pads before the emit loops count them down.
+    prof.cbuf_len = cbuf_len;
+#if NANOPRINTF_USE_FIELD_WIDTH_FORMAT_SPECIFIERS == 1
+    prof.field_pad = field_pad;
+#endif
+#if NANOPRINTF_USE_PRECISION_FORMAT_SPECIFIERS == 1
+    prof.prec_pad = prec_pad;
+#endif
+#endif
+#if NANOPRINTF_USE_FIELD_WIDTH_FORMAT_SPECIFIERS == 1
     if (!fs.left_justified) {
       while (field_pad-- > 0) { NPF_PUT(pad_c); }
     }
@@ -2040,11 +4382,58 @@ int npf_vpprintf(npf_putc pc, void *pc_ctx, char const *format, va_list args) {
     // Write the converted payload. The STRING parse loop guarantees cbuf_len == 0
     // when cbuf is NULL, so the output loop can elide the `cbuf &&` check.
     if (fs.conv_spec == NPF_FMT_SPEC_CONV_STRING) {
-      for (int i = 0; i < cbuf_len; ++i) { NPF_PUT(cbuf[i]); }
-    } else {
+#if NANOPRINTF_USE_ESCAPED_STRING_FORMAT_SPECIFIERS == 1
+      if (esc) { npf_esc_put(cbuf, esc_len, esc == 'c', pc, pc_ctx); } else
+#endif
+      { for (int i = 0; i < cbuf_len; ++i) { NPF_PUT(cbuf[i]); } }
+    } else
+#if NANOPRINTF_USE_FLOAT_EXACT == 1
+    if (exact.l) {
+      npf_exact_put(&exact, pc, pc_ctx);
+    } else
+#endif
+#if NANOPRINTF_USE_FLOAT_STREAMING == 1
+    if (stream) {
+      npf_ftoa_stream(pc, pc_ctx, &fs, NPF_DEC_PREC(&fs), stream_val);
+    } else
+#endif
+#if NANOPRINTF_USE_BIGNUM_FORMAT_SPECIFIERS == 1
+    if (big.digits) {
+      npf_big_put(&big, pc, pc_ctx);
+    } else
+#endif
+#if NANOPRINTF_USE_HEXDUMP_FORMAT_SPECIFIER == 1
+    if (fs.conv_spec == NPF_FMT_SPEC_CONV_HEXDUMP) {
+      npf_hexdump_put(&dump, pc, pc_ctx);
+    } else
+#endif
+#if NANOPRINTF_USE_CUSTOM_FORMAT_SPECIFIERS == 1
+    if (custom_fn) {
+      int const n = custom_fn(pc, pc_ctx, &custom);
+      spec_len += n - cbuf_len; // replaces the count it measured, if any
+#if NANOPRINTF_USE_FIELD_WIDTH_FORMAT_SPECIFIERS == 1
+      if (fs.left_justified) { // the pad after it was sized before its length was known
+        spec_len -= field_pad;
+        field_pad = NPF_MAX(0, fs.field_width - n);
+        spec_len += field_pad;
+      }
+#endif
+    } else
+#endif
+    {
 #if NANOPRINTF_USE_BINARY_FORMAT_SPECIFIERS == 1
       if (fs.conv_spec == NPF_FMT_SPEC_CONV_BINARY) {
+#if NANOPRINTF_USE_SWAR_DIGIT_CONVERSION == 1
+        char bits[8];
+        while (cbuf_len) { // the top partial byte first, then whole bytes
+          int const n = ((cbuf_len - 1) & 7) + 1;
+          cbuf_len -= n;
+          npf_bits8((unsigned)(u.binval >> cbuf_len) & 0xFFu, bits);
+          for (int i = 8 - n; i < 8; ++i) { NPF_PUT(bits[i]); }
+        }
+#else
         while (cbuf_len) { NPF_PUT('0' + ((u.binval >> --cbuf_len) & 1)); }
+#endif
       } else
 #endif
       { while (cbuf_len-- > 0) { NPF_PUT(cbuf[cbuf_len]); } } // payload is reversed
@@ -2055,14 +4444,28 @@ int npf_vpprintf(npf_putc pc, void *pc_ctx, char const *format, va_list args) {
     // already run field_pad below zero in the non-left-justified case, so
     // this loop body only executes for left-justified specifiers.
     while (field_pad-- > 0) { NPF_PUT(pad_c); }
+#endif
+#if NANOPRINTF_USE_PROFILE_HOOKS == 1
+    npf_profile_end(&prof);
 #endif
     // NPF_PUT emissions don't tally npf_n; add the conversion's total length in bulk.
     npf_n += spec_len;
+#if NANOPRINTF_USE_ARRAY_FORMAT_SPECIFIERS == 1
+    if (arr.n > 0) { // the separator, then the next element under the same spec
+      for (char const *s = arr.sep; s && *s; ++s) { NPF_PUTC(*s); }
+      fs = fs_elem;
+#if NANOPRINTF_USE_PROFILE_HOOKS == 1
+      npf_profile_begin(&prof, prof.spec, prof.spec + prof.spec_len, fs.length_modifier);
+#endif
+      goto npf_array_elem;
+    }
+#endif
   }
 
   return npf_n;
 }
 
+#undef NPF_ARG
 #undef NPF_PUTC
 #undef NPF_PUT
 #undef NPF_EXTRACT
@@ -2076,6 +4479,10 @@ int npf_vpprintf(npf_putc pc, void *pc_ctx, char const *format, va_list args) {
   #undef NPF_FMT_SPEC_CONV_FLOAT_SCI_FIRST
 #endif
 #undef NPF_USE_SCI
+#undef NPF_USE_ETOA
+#ifdef NPF_F32_FRAC
+  #undef NPF_F32_FRAC
+#endif
 
 int npf_vsnprintf(char * NPF_RESTRICT buffer,
                   size_t bufsz,
@@ -2118,6 +4525,1241 @@ int npf_snprintf_(char * NPF_RESTRICT buffer,
   return rv;
 }
 
+int npf_pprintf_ext_(npf_putc pc,
+                     void * NPF_RESTRICT pc_ctx,
+                     char const * NPF_RESTRICT format,
+                     ...) {
+  va_list val;
+  va_start(val, format);
+  int const rv = npf_vpprintf(pc, pc_ctx, format, val);
+  va_end(val);
+  return rv;
+}
+
+int npf_snprintf_ext_(char * NPF_RESTRICT buffer,
+                      size_t bufsz,
+                      const char * NPF_RESTRICT format,
+                      ...) {
+  va_list val;
+  va_start(val, format);
+  int const rv = npf_vsnprintf(buffer, bufsz, format, val);
+  va_end(val);
+  return rv;
+}
+
+#if (NANOPRINTF_USE_STRUCTURED_LOG == 1) || (NANOPRINTF_USE_FORMAT_INTERNING == 1) || \
+    (NANOPRINTF_USE_DEFERRED_LOG == 1) || (NANOPRINTF_USE_DEDUP_SINK == 1)
+/* Argument capture: one conversion's varargs, taken off a va_list by its parsed
+   spec and held by value, to be converted later through npf_pprintf_ext with a
+   spec rebuilt to read them back. Integers are held at the widest type a length
+   modifier in this build reads, so the rebuilt spec needs only one modifier. */
+#if NANOPRINTF_USE_LARGE_FORMAT_SPECIFIERS == 1
+  typedef intmax_t npf_arg_int_t;
+  typedef uintmax_t npf_arg_uint_t;
+  #define NPF_ARG_LM 'j'
+  #define NPF_ARG_LM_LAST NPF_FMT_SPEC_LEN_MOD_LARGE_PTRDIFFT
+#else
+  typedef long npf_arg_int_t;
+  typedef unsigned long npf_arg_uint_t;
+  #define NPF_ARG_LM 'l'
+  #define NPF_ARG_LM_LAST NPF_FMT_SPEC_LEN_MOD_LONG
+#endif
+
+enum { // which npf_arg_t member holds the value
+  NPF_ARG_NONE,  // '%'
+  NPF_ARG_CHAR,  // i
+  NPF_ARG_STR,   // p
+  NPF_ARG_INT,   // i
+  NPF_ARG_UINT,  // u
+  NPF_ARG_PTR,   // p
+  NPF_ARG_REAL,  // r
+};
+
+typedef union npf_arg {
+  npf_arg_int_t i;
+  npf_arg_uint_t u;
+  void const *p;
+#if NANOPRINTF_USE_FLOAT_FORMAT_SPECIFIERS == 1
+  npf_real_t r;
+#endif
+} npf_arg_t;
+
+// What fs takes, or -1 for the extensions whose varargs capture doesn't know.
+static int npf_arg_kind(npf_format_spec_t const *fs) {
+#if NANOPRINTF_USE_ARRAY_FORMAT_SPECIFIERS == 1
+  if (fs->array) { return -1; }
+#endif
+  switch (fs->conv_spec) {
+    case NPF_FMT_SPEC_CONV_PERCENT: return NPF_ARG_NONE;
+    case NPF_FMT_SPEC_CONV_CHAR: return NPF_ARG_CHAR;
+    case NPF_FMT_SPEC_CONV_STRING: return NPF_ARG_STR;
+    case NPF_FMT_SPEC_CONV_POINTER: return NPF_ARG_PTR;
+    case NPF_FMT_SPEC_CONV_SIGNED_INT:
+      return (fs->length_modifier <= NPF_ARG_LM_LAST) ? NPF_ARG_INT : -1;
+#if NANOPRINTF_USE_BINARY_FORMAT_SPECIFIERS == 1
+    case NPF_FMT_SPEC_CONV_BINARY:
+#endif
+    case NPF_FMT_SPEC_CONV_OCTAL:
+    case NPF_FMT_SPEC_CONV_HEX_INT:
+    case NPF_FMT_SPEC_CONV_UNSIGNED_INT:
+      return (fs->length_modifier <= NPF_ARG_LM_LAST) ? NPF_ARG_UINT : -1;
+    default: break;
+  }
+#if NANOPRINTF_USE_FLOAT_FORMAT_SPECIFIERS == 1
+  if ((fs->conv_spec >= NPF_FMT_SPEC_CONV_FLOAT_DEC) &&
+      (fs->length_modifier <= NPF_FMT_SPEC_LEN_MOD_LONG_DOUBLE)) {
+    return NPF_ARG_REAL;
+  }
+#endif
+  return -1;
+}
+
+/* Takes fs's varargs off *args: star width and precision first, folded into fs the
+   way npf_vpprintf folds them, then the value, widened to its npf_arg_t member. */
+static void npf_arg_take(npf_format_spec_t *fs, va_list *args, int kind, npf_arg_t *a) {
+#if NANOPRINTF_USE_FIELD_WIDTH_FORMAT_SPECIFIERS == 1
+  if (fs->field_width_opt == NPF_FMT_SPEC_OPT_STAR) {
+    unsigned w = (unsigned)va_arg(*args, int);
+    if ((int)w < 0) { w = 0u - w; fs->left_justified = '-'; }
+    fs->field_width = (int)NPF_MIN(w, (unsigned)NPF_FMT_NUM_MAX);
+    fs->field_width_opt = NPF_FMT_SPEC_OPT_LITERAL;
+  }
+#endif
+#if NANOPRINTF_USE_PRECISION_FORMAT_SPECIFIERS == 1
+  if (fs->prec_opt == NPF_FMT_SPEC_OPT_STAR) {
+    fs->prec = NPF_MIN(va_arg(*args, int), NPF_FMT_NUM_MAX);
+    fs->prec_opt = (fs->prec < 0) ? NPF_FMT_SPEC_OPT_NONE : NPF_FMT_SPEC_OPT_LITERAL;
+  }
+#endif
+  a->u = 0;
+  switch (kind) {
+    case NPF_ARG_CHAR: a->i = va_arg(*args, int); break;
+    case NPF_ARG_STR: a->p = va_arg(*args, char const *); break;
+    case NPF_ARG_PTR: a->p = va_arg(*args, void const *); break;
+    case NPF_ARG_INT:
+      switch (fs->length_modifier) {
+        case NPF_FMT_SPEC_LEN_MOD_LONG: a->i = va_arg(*args, long); break;
+#if NANOPRINTF_USE_LARGE_FORMAT_SPECIFIERS == 1
+        case NPF_FMT_SPEC_LEN_MOD_LARGE_LONG_LONG: a->i = va_arg(*args, long long); break;
+        case NPF_FMT_SPEC_LEN_MOD_LARGE_INTMAX: a->i = va_arg(*args, intmax_t); break;
+        case NPF_FMT_SPEC_LEN_MOD_LARGE_SIZET: a->i = va_arg(*args, npf_ssize_t); break;
+        case NPF_FMT_SPEC_LEN_MOD_LARGE_PTRDIFFT: a->i = va_arg(*args, ptrdiff_t); break;
+#endif
+#if NANOPRINTF_USE_SMALL_FORMAT_SPECIFIERS == 1
+        case NPF_FMT_SPEC_LEN_MOD_SHORT: a->i = (short)va_arg(*args, int); break;
+        case NPF_FMT_SPEC_LEN_MOD_CHAR: a->i = (signed char)va_arg(*args, int); break;
+#endif
+        default: a->i = va_arg(*args, int); break;
+      }
+      break;
+    case NPF_ARG_UINT:
+      switch (fs->length_modifier) {
+        case NPF_FMT_SPEC_LEN_MOD_LONG: a->u = va_arg(*args, unsigned long); break;
+#if NANOPRINTF_USE_LARGE_FORMAT_SPECIFIERS == 1
+        case NPF_FMT_SPEC_LEN_MOD_LARGE_LONG_LONG:
+          a->u = va_arg(*args, unsigned long long);
+          break;
+        case NPF_FMT_SPEC_LEN_MOD_LARGE_INTMAX: a->u = va_arg(*args, uintmax_t); break;
+        case NPF_FMT_SPEC_LEN_MOD_LARGE_SIZET: a->u = va_arg(*args, size_t); break;
+        case NPF_FMT_SPEC_LEN_MOD_LARGE_PTRDIFFT:
+          a->u = va_arg(*args, npf_uptrdiff_t);
+          break;
+#endif
+#if NANOPRINTF_USE_SMALL_FORMAT_SPECIFIERS == 1
+        case NPF_FMT_SPEC_LEN_MOD_SHORT:
+          a->u = (unsigned short)va_arg(*args, unsigned);
+          break;
+        case NPF_FMT_SPEC_LEN_MOD_CHAR: a->u = (unsigned char)va_arg(*args, unsigned); break;
+#endif
+        default: a->u = va_arg(*args, unsigned); break;
+      }
+      break;
+#if NANOPRINTF_USE_FLOAT_FORMAT_SPECIFIERS == 1
+    case NPF_ARG_REAL:
+#if NANOPRINTF_USE_FLOAT_SINGLE_PRECISION == 1
+      a->r = va_arg(*args, npf_float_t).val;
+#else
+      if (fs->length_modifier == NPF_FMT_SPEC_LEN_MOD_LONG_DOUBLE) {
+        a->r = (npf_real_t)va_arg(*args, long double);
+      } else {
+        a->r = va_arg(*args, double);
+      }
+#endif
+      break;
+#endif
+    default: break;
+  }
+}
+
+static char *npf_arg_spec_num(char *p, int n) {
+  char d[12];
+  int i = 0;
+  do { d[i++] = (char)('0' + (n % 10)); n /= 10; } while (n);
+  while (i) { *p++ = d[--i]; }
+  return p;
+}
+
+/* Spells fs back out, ending in conv, as a specifier that reads the value the way
+   npf_arg_t holds it; out needs room for two 10-digit numbers. */
+static void npf_arg_spec(npf_format_spec_t const *fs, int kind, char conv, char *out) {
+  *out++ = '%';
+#if NANOPRINTF_USE_FIELD_WIDTH_FORMAT_SPECIFIERS == 1
+  if (fs->left_justified) { *out++ = '-'; }
+  if (fs->leading_zero_pad) { *out++ = '0'; }
+#endif
+  if (fs->prepend) { *out++ = fs->prepend; }
+#if NANOPRINTF_USE_ALT_FORM_FLAG == 1
+  if (fs->alt_form) { *out++ = '#'; }
+#endif
+#if NANOPRINTF_USE_FIELD_WIDTH_FORMAT_SPECIFIERS == 1
+  if (fs->field_width) { out = npf_arg_spec_num(out, fs->field_width); }
+#endif
+#if NANOPRINTF_USE_PRECISION_FORMAT_SPECIFIERS == 1
+  if (fs->prec_opt != NPF_FMT_SPEC_OPT_NONE) {
+    *out++ = '.';
+    out = npf_arg_spec_num(out, fs->prec);
+  }
+#endif
+  if ((kind == NPF_ARG_INT) || (kind == NPF_ARG_UINT)) { *out++ = NPF_ARG_LM; }
+  *out++ = conv;
+  *out = '\0';
+}
+
+// Converts a captured argument as fs, ending in conv, would have converted it.
+static int npf_arg_put(npf_putc pc, void *pc_ctx, npf_format_spec_t const *fs,
+                       int kind, char conv, npf_arg_t const *a) {
+  char spec[32];
+  npf_arg_spec(fs, kind, conv, spec);
+  switch (kind) {
+    case NPF_ARG_CHAR: return npf_pprintf_ext_(pc, pc_ctx, spec, (int)a->i);
+    case NPF_ARG_STR: return npf_pprintf_ext_(pc, pc_ctx, spec, (char const *)a->p);
+    case NPF_ARG_PTR: return npf_pprintf_ext_(pc, pc_ctx, spec, a->p);
+    case NPF_ARG_INT: return npf_pprintf_ext_(pc, pc_ctx, spec, a->i);
+    case NPF_ARG_UINT: return npf_pprintf_ext_(pc, pc_ctx, spec, a->u);
+#if NANOPRINTF_USE_FLOAT_FORMAT_SPECIFIERS == 1
+    case NPF_ARG_REAL: {
+#if NANOPRINTF_USE_FLOAT_SINGLE_PRECISION == 1
+      npf_float_t f;
+      f.val = a->r;
+      return npf_pprintf_ext_(pc, pc_ctx, spec, f);
+#else
+      return npf_pprintf_ext_(pc, pc_ctx, spec, (double)a->r);
+#endif
+    }
+#endif
+    default: return npf_pprintf_ext_(pc, pc_ctx, spec);
+  }
+}
+#endif
+
+#if NANOPRINTF_USE_STRUCTURED_LOG == 1
+// The encoders write through this, so the count and JSON escaping live in one place.
+typedef struct npf_log_out {
+  npf_putc pc;
+  void *pc_ctx;
+  int n;
+  char esc; // inside a JSON string
+} npf_log_out_t;
+
+static void npf_log_byte(npf_log_out_t *o, int c) {
+  o->pc(c, o->pc_ctx);
+  ++o->n;
+}
+
+// The npf_putc the converters write JSON through.
+static void npf_log_putc(int c, void *ctx) {
+  npf_log_out_t *const o = (npf_log_out_t *)ctx;
+  if (o->esc && ((((unsigned)c & 0xFFu) < 0x20u) || (c == '"') || (c == '\\'))) {
+    o->pc('\\', o->pc_ctx);
+    if ((c == '"') || (c == '\\')) {
+      o->pc(c, o->pc_ctx);
+      o->n += 2;
+    } else { // a control character: \u00XX
+      o->pc('u', o->pc_ctx); o->pc('0', o->pc_ctx); o->pc('0', o->pc_ctx);
+      o->pc('0' + ((c >> 4) & 1), o->pc_ctx);
+      o->pc("0123456789abcdef"[c & 0xF], o->pc_ctx);
+      o->n += 6;
+    }
+    return;
+  }
+  npf_log_byte(o, c);
+}
+
+// A CBOR data item head: the major type and its argument in the fewest bytes.
+static void npf_cbor_head(npf_log_out_t *o, unsigned major, npf_arg_uint_t v) {
+  int nb = (v < 24u) ? 0 : (v <= 0xFFu) ? 1 : (v <= 0xFFFFu) ? 2 :
+           ((v >> 16) >> 16) ? 8 : 4; // two shifts: v may be only 32 bits wide
+  static unsigned char const ai[9] = { 0, 24, 25, 0, 26, 0, 0, 0, 27 };
+  npf_log_byte(o, (int)((major << 5) | (nb ? ai[nb] : (unsigned)v)));
+  while (nb--) { npf_log_byte(o, (int)((v >> (8 * nb)) & 0xFFu)); }
+}
+
+static void npf_cbor_text(npf_log_out_t *o, char const *s, int len) {
+  npf_cbor_head(o, 3u, (npf_arg_uint_t)len);
+  for (int i = 0; i < len; ++i) { npf_log_byte(o, s[i]); }
+}
+
+// The value as CBOR: integers and floats in binary, no decimal conversion.
+static void npf_log_cbor_value(npf_log_out_t *o, npf_format_spec_t const *fs, int kind,
+                               npf_arg_t const *a) {
+  switch (kind) {
+    case NPF_ARG_INT:
+      if (a->i < 0) { npf_cbor_head(o, 1u, (npf_arg_uint_t)(-(a->i + 1))); break; }
+      npf_cbor_head(o, 0u, (npf_arg_uint_t)a->i);
+      break;
+    case NPF_ARG_UINT: npf_cbor_head(o, 0u, a->u); break;
+    case NPF_ARG_PTR: npf_cbor_head(o, 0u, (npf_arg_uint_t)(uintptr_t)a->p); break;
+    case NPF_ARG_CHAR: {
+      char const c = (char)a->i;
+      npf_cbor_text(o, &c, 1);
+    } break;
+    case NPF_ARG_STR: {
+      char const *const s = (char const *)a->p;
+      int len = 0;
+      if (!s) { npf_log_byte(o, 0xF6); break; } // null
+#if NANOPRINTF_USE_PRECISION_FORMAT_SPECIFIERS == 1
+      while (((fs->prec_opt == NPF_FMT_SPEC_OPT_NONE) || (len < fs->prec)) && s[len]) {
+        ++len;
+      }
+#else
+      while (s[len]) { ++len; }
+#endif
+      npf_cbor_text(o, s, len);
+    } break;
+#if NANOPRINTF_USE_FLOAT_FORMAT_SPECIFIERS == 1
+    case NPF_ARG_REAL: {
+      npf_real_bin_t const bits = npf_real_to_int_rep(a->r);
+      int const nb = (int)sizeof(npf_real_t);
+      npf_log_byte(o, (nb == 8) ? 0xFB : 0xFA); // float64 or float32
+      for (int i = nb; i--;) { npf_log_byte(o, (int)((bits >> (8 * i)) & 0xFFu)); }
+    } break;
+#endif
+    default: break;
+  }
+  (void)fs;
+}
+
+/* The value as JSON. Decimal integers and finite decimal floats are numbers, printed
+   bare because flags and width can make them invalid JSON; a float keeps its
+   precision. Everything else is a string, converted as the spec says and escaped. */
+static void npf_log_null(npf_log_out_t *o) {
+  for (char const *s = "null"; *s; ++s) { npf_log_byte(o, *s); }
+}
+
+/* A bare JSON number, held back until its first digit shows that the converter
+   produced one: a %f too long for the conversion buffer prints err, or -ERR. */
+typedef struct npf_log_num {
+  npf_log_out_t *o;
+  char state; // 0 before anything, '-' on a held sign, 'd' in digits, 'x' for text
+} npf_log_num_t;
+
+static void npf_log_num_putc(int c, void *ctx) {
+  npf_log_num_t *const nm = (npf_log_num_t *)ctx;
+  if (nm->state == 'd') { npf_log_byte(nm->o, c); return; }
+  if (nm->state == 'x') { return; }
+  if ((c == '-') && !nm->state) { nm->state = '-'; return; }
+  if ((unsigned)(c - '0') >= 10u) { nm->state = 'x'; return; }
+  if (nm->state == '-') { npf_log_byte(nm->o, '-'); }
+  npf_log_byte(nm->o, c);
+  nm->state = 'd';
+}
+
+static void npf_log_json_value(npf_log_out_t *o, npf_format_spec_t const *fs, int kind,
+                               char conv, npf_arg_t const *a) {
+  npf_format_spec_t bare = *fs;
+  int number = (kind == NPF_ARG_INT) ||
+               ((kind == NPF_ARG_UINT) && (fs->conv_spec == NPF_FMT_SPEC_CONV_UNSIGNED_INT));
+#if NANOPRINTF_USE_FLOAT_FORMAT_SPECIFIERS == 1
+  if (kind == NPF_ARG_REAL) {
+    npf_real_bin_t const exp =
+      (npf_real_to_int_rep(a->r) >> NPF_REAL_MAN_BITS) & NPF_REAL_EXP_MASK;
+    number = (exp != NPF_REAL_EXP_MASK)
+#if NANOPRINTF_USE_FLOAT_HEX_FORMAT_SPECIFIER == 1
+             && (fs->conv_spec != NPF_FMT_SPEC_CONV_FLOAT_HEX)
+#endif
+             ;
+  }
+#endif
+  if ((kind == NPF_ARG_STR) && !a->p) {
+    npf_log_null(o);
+    return;
+  }
+  if (!number) {
+    npf_log_putc('"', o);
+    o->esc = 1;
+    npf_arg_put(npf_log_putc, o, fs, kind, conv, a);
+    o->esc = 0;
+    npf_log_putc('"', o);
+    return;
+  }
+#if NANOPRINTF_USE_FIELD_WIDTH_FORMAT_SPECIFIERS == 1
+  bare.left_justified = bare.leading_zero_pad = 0;
+  bare.field_width = 0;
+#endif
+#if NANOPRINTF_USE_ALT_FORM_FLAG == 1
+  bare.alt_form = 0;
+#endif
+#if NANOPRINTF_USE_PRECISION_FORMAT_SPECIFIERS == 1
+  if (kind != NPF_ARG_REAL) { bare.prec_opt = NPF_FMT_SPEC_OPT_NONE; }
+#endif
+  bare.prepend = 0;
+  npf_log_num_t nm;
+  nm.o = o;
+  nm.state = 0;
+  npf_arg_put(npf_log_num_putc, &nm, &bare, kind, conv, a);
+  if (nm.state != 'd') { // not a number after all
+    npf_log_null(o);
+  }
+}
+
+// Fields are named by the word before the '=' or ':' their specifier follows.
+static int npf_log_name(char const *format, char const *spec, char const **name) {
+  char const *s = spec;
+  while ((s > format) && (s[-1] == ' ')) { --s; }
+  if ((s == format) || ((s[-1] != '=') && (s[-1] != ':'))) { return 0; }
+  --s;
+  while ((s > format) && (s[-1] == ' ')) { --s; }
+  char const *const name_end = s;
+  while ((s > format) && (((s[-1] | 32) >= 'a' && (s[-1] | 32) <= 'z') ||
+                          (s[-1] >= '0' && s[-1] <= '9') || (s[-1] == '_') ||
+                          (s[-1] == '.') || (s[-1] == '-'))) {
+    --s;
+  }
+  *name = s;
+  return (int)(name_end - s);
+}
+
+int npf_vlog(npf_log_sink_t const *sink, char const *format, va_list vlist) {
+  if (sink->encoding == NPF_LOG_TEXT) {
+    return npf_vpprintf(sink->pc, sink->pc_ctx, format, vlist);
+  }
+  char const json = (sink->encoding == NPF_LOG_JSON);
+  npf_log_out_t o;
+  o.pc = sink->pc;
+  o.pc_ctx = sink->pc_ctx;
+  o.n = 0;
+  o.esc = 0;
+  va_list args;
+  va_copy(args, vlist); // taken by address below, which a parameter can't always be
+  npf_log_byte(&o, json ? '{' : 0xBF); // CBOR: a map of indefinite length
+  int field = 0;
+  for (char const *cur = format; *cur;) {
+    npf_format_spec_t fs;
+    char const *const end = (*cur == '%') ? npf_parse_format_spec_end(cur, &fs) : NULL;
+    if (!end) { ++cur; continue; }
+    int const kind = npf_arg_kind(&fs);
+    if (kind < 0) { break; } // its varargs are unknown, so nothing after it is safe
+    npf_arg_t a;
+    npf_arg_take(&fs, &args, kind, &a);
+    if (kind != NPF_ARG_NONE) {
+      char const *name = NULL;
+      int const name_len = npf_log_name(format, cur, &name);
+      if (json) {
+        if (field) { npf_log_putc(',', &o); }
+        npf_log_putc('"', &o);
+        if (name_len) {
+          for (int i = 0; i < name_len; ++i) { npf_log_putc(name[i], &o); }
+        } else {
+          npf_pprintf_ext_(npf_log_putc, &o, "%d", field);
+        }
+        npf_log_putc('"', &o);
+        npf_log_putc(':', &o);
+        npf_log_json_value(&o, &fs, kind, end[-1], &a);
+      } else {
+        if (name_len) { npf_cbor_text(&o, name, name_len); }
+        else { npf_cbor_head(&o, 0u, (npf_arg_uint_t)field); }
+        npf_log_cbor_value(&o, &fs, kind, &a);
+      }
+      ++field;
+    }
+    cur = end;
+  }
+  npf_log_byte(&o, json ? '}' : 0xFF);
+  va_end(args);
+  return o.n;
+}
+
+int npf_log_(npf_log_sink_t const *sink, char const *format, ...) {
+  va_list val;
+  va_start(val, format);
+  int const rv = npf_vlog(sink, format, val);
+  va_end(val);
+  return rv;
+}
+#endif
+
+#if NANOPRINTF_USE_STRING_BUILDER == 1
+void npf_strbuf_init(npf_strbuf_t *sb, char *buf, int size, npf_strbuf_grow_fn grow,
+                     void *grow_ctx) {
+  sb->first.next = NULL;
+  sb->first.data = buf;
+  sb->first.cap = (buf && (size > 0)) ? size : 0;
+  sb->first.len = 0;
+  sb->tail = &sb->first;
+  sb->grow = grow;
+  sb->grow_ctx = grow_ctx;
+  sb->len = sb->dropped = 0;
+}
+
+static npf_strbuf_chunk_t *npf_strbuf_new_chunk(npf_strbuf_t *sb, int min) {
+  npf_strbuf_chunk_t *const c = sb->grow ? sb->grow(sb->grow_ctx, min) : NULL;
+  if (!c || !c->data || (c->cap < min)) { return NULL; }
+  c->next = NULL;
+  c->len = 0;
+  return c;
+}
+
+void npf_strbuf_putc(int c, void *ctx) {
+  npf_strbuf_t *const sb = (npf_strbuf_t *)ctx;
+  npf_strbuf_chunk_t *t = sb->tail;
+  ++sb->len;
+  if (t->len == t->cap) {
+    // Once a byte is lost the rest are too, so the kept text is always a prefix.
+    npf_strbuf_chunk_t *const n = sb->dropped ? NULL : npf_strbuf_new_chunk(sb, 1);
+    if (!n) { ++sb->dropped; return; }
+    t->next = n;
+    sb->tail = t = n;
+  }
+  t->data[t->len++] = (char)c;
+}
+
+int npf_strbuf_vappendf(npf_strbuf_t *sb, char const *format, va_list vlist) {
+  return npf_vpprintf(npf_strbuf_putc, sb, format, vlist);
+}
+
+int npf_strbuf_appendf_(npf_strbuf_t *sb, char const *format, ...) {
+  va_list val;
+  va_start(val, format);
+  int const rv = npf_strbuf_vappendf(sb, format, val);
+  va_end(val);
+  return rv;
+}
+
+int npf_strbuf_copy(npf_strbuf_t const *sb, char *dst, size_t size) {
+  size_t n = 0;
+  for (npf_strbuf_chunk_t const *c = &sb->first; c && (n + 1 < size); c = c->next) {
+    for (int i = 0; (i < c->len) && (n + 1 < size); ++i) { dst[n++] = c->data[i]; }
+  }
+  if (dst && size) { dst[n] = '\0'; }
+  return sb->len - sb->dropped;
+}
+
+char *npf_strbuf_flatten(npf_strbuf_t *sb) {
+  npf_strbuf_chunk_t *const f = &sb->first;
+  if (!f->next && (f->len < f->cap)) {
+    f->data[f->len] = '\0';
+    return f->data;
+  }
+  int const kept = sb->len - sb->dropped;
+  npf_strbuf_chunk_t const *const c = npf_strbuf_new_chunk(sb, kept + 1);
+  if (!c) { return NULL; }
+  npf_strbuf_copy(sb, c->data, (size_t)kept + 1);
+  // The new chunk becomes the only one; the old ones stay with their allocator.
+  f->next = NULL;
+  f->data = c->data;
+  f->cap = c->cap;
+  f->len = kept;
+  sb->tail = f;
+  return f->data;
+}
+
+npf_strbuf_chunk_t *npf_strbuf_arena_grow(void *arena, int min) {
+  npf_strbuf_arena_t *const a = (npf_strbuf_arena_t *)arena;
+  uintptr_t const mask = sizeof(void *) - 1; // the header holds a pointer
+  if (!a->p || ((uintptr_t)a->end < (((uintptr_t)a->p + mask) & ~mask))) { return NULL; }
+  char *const h = a->p + ((((uintptr_t)a->p + mask) & ~mask) - (uintptr_t)a->p);
+  ptrdiff_t const left = (a->end - h) - (ptrdiff_t)sizeof(npf_strbuf_chunk_t);
+  if (left < (ptrdiff_t)min) { return NULL; }
+  int const room = (left > INT_MAX) ? INT_MAX : (int)left;
+  npf_strbuf_chunk_t *const c = (npf_strbuf_chunk_t *)(void *)h;
+  c->data = h + sizeof(npf_strbuf_chunk_t);
+  c->cap = ((a->chunk > 0) && (a->chunk < room)) ? NPF_MAX(a->chunk, min) : room;
+  a->p = c->data + c->cap;
+  return c;
+}
+#endif
+
+#if NANOPRINTF_USE_ASPRINTF == 1
+// The sizing pass: it only needs npf_vpprintf's count.
+static void npf_count_putc(int c, void *ctx) { (void)c; (void)ctx; }
+
+char *npf_vasprintf_buf(char *buf, size_t bufsz, npf_alloc_fn alloc, void *alloc_ctx,
+                        char const *format, va_list vlist) {
+  va_list args;
+  va_copy(args, vlist);
+  int const n = (buf && bufsz) ? npf_vsnprintf(buf, bufsz, format, args)
+                               : npf_vpprintf(npf_count_putc, NULL, format, args);
+  va_end(args);
+  if (buf && ((size_t)n < bufsz)) { return buf; }
+  char *const p = (char *)alloc(alloc_ctx, (size_t)n + 1u);
+  if (p) { npf_vsnprintf(p, (size_t)n + 1u, format, vlist); }
+  return p;
+}
+
+char *npf_vasprintf(npf_alloc_fn alloc, void *alloc_ctx, char const *format,
+                    va_list vlist) {
+  return npf_vasprintf_buf(NULL, 0, alloc, alloc_ctx, format, vlist);
+}
+
+char *npf_asprintf_(npf_alloc_fn alloc, void *alloc_ctx, char const *format, ...) {
+  va_list val;
+  va_start(val, format);
+  char *const rv = npf_vasprintf(alloc, alloc_ctx, format, val);
+  va_end(val);
+  return rv;
+}
+
+char *npf_asprintf_buf_(char *buf, size_t bufsz, npf_alloc_fn alloc, void *alloc_ctx,
+                        char const *format, ...) {
+  va_list val;
+  va_start(val, format);
+  char *const rv = npf_vasprintf_buf(buf, bufsz, alloc, alloc_ctx, format, val);
+  va_end(val);
+  return rv;
+}
+#endif
+
+#if NANOPRINTF_USE_TEE_SINK == 1
+void npf_tee_init(npf_tee_t *tee, npf_tee_child_t const *child, int n) {
+  tee->child = child;
+  tee->n = child ? n : 0;
+  tee->cls = ~0u;
+}
+
+void npf_tee_putc(int c, void *ctx) {
+  npf_tee_t const *const tee = (npf_tee_t const *)ctx;
+  for (int i = 0; i < tee->n; ++i) {
+    npf_tee_child_t const *const ch = &tee->child[i];
+    if (ch->filter & tee->cls) { ch->pc(c, ch->pc_ctx); }
+  }
+}
+
+int npf_tee_vpprintf(npf_tee_t *tee, unsigned cls, char const *format, va_list vlist) {
+  int i = 0;
+  while ((i < tee->n) && !(tee->child[i].filter & cls)) { ++i; }
+  if (i == tee->n) { return 0; } // nobody takes it: skip the conversions too
+  unsigned const was = tee->cls;
+  tee->cls = cls;
+  int const n = npf_vpprintf(npf_tee_putc, tee, format, vlist);
+  tee->cls = was;
+  return n;
+}
+
+int npf_tee_pprintf_(npf_tee_t *tee, unsigned cls, char const *format, ...) {
+  va_list val;
+  va_start(val, format);
+  int const rv = npf_tee_vpprintf(tee, cls, format, val);
+  va_end(val);
+  return rv;
+}
+#endif
+
+#if NANOPRINTF_USE_FORMAT_INTERNING == 1
+#ifdef __cplusplus
+extern "C" {
+#endif
+extern char const __start_npf_fmt[] __attribute__((weak)); // from the linker
+#ifdef __cplusplus
+}
+#endif
+
+unsigned long npf_fmt_id(char const *fmt) {
+  return (unsigned long)((uintptr_t)fmt - (uintptr_t)__start_npf_fmt);
+}
+
+/* Record layout: the ID, then per conversion its star width and precision if it
+   has them, then its value. Integers are LEB128 varints, signed ones zigzagged so
+   small negatives stay short; a string is its length then its bytes; a float is
+   npf_real_t's bits, low byte first. */
+typedef struct npf_fmt_out {
+  npf_putc pc;
+  void *pc_ctx;
+  int n;
+} npf_fmt_out_t;
+
+static void npf_fmt_put_u(npf_fmt_out_t *o, npf_arg_uint_t v) {
+  for (; v >= 0x80u; v >>= 7, ++o->n) { o->pc((int)((v & 0x7Fu) | 0x80u), o->pc_ctx); }
+  o->pc((int)v, o->pc_ctx);
+  ++o->n;
+}
+
+static void npf_fmt_put_i(npf_fmt_out_t *o, npf_arg_int_t v) {
+  npf_fmt_put_u(o, (v < 0) ? ((((npf_arg_uint_t)-(v + 1)) << 1) | 1u)
+                           : ((npf_arg_uint_t)v << 1));
+}
+
+int npf_fmt_vsend(npf_putc pc, void *pc_ctx, char const *fmt, va_list vlist) {
+  npf_fmt_out_t o;
+  o.pc = pc;
+  o.pc_ctx = pc_ctx;
+  o.n = 0;
+  va_list args;
+  va_copy(args, vlist); // taken by address below, which a parameter can't always be
+  npf_fmt_put_u(&o, npf_fmt_id(fmt));
+  for (char const *cur = fmt; *cur;) {
+    npf_format_spec_t fs;
+    char const *const end = (*cur == '%') ? npf_parse_format_spec_end(cur, &fs) : NULL;
+    if (!end) { ++cur; continue; }
+    int const kind = npf_arg_kind(&fs);
+    if (kind < 0) { break; } // the host stops at the same conversion
+#if NANOPRINTF_USE_FIELD_WIDTH_FORMAT_SPECIFIERS == 1
+    char const star_w = (fs.field_width_opt == NPF_FMT_SPEC_OPT_STAR);
+#endif
+    char const star_p = (fs.prec_opt == NPF_FMT_SPEC_OPT_STAR);
+    npf_arg_t a;
+    npf_arg_take(&fs, &args, kind, &a);
+#if NANOPRINTF_USE_FIELD_WIDTH_FORMAT_SPECIFIERS == 1
+    if (star_w) { npf_fmt_put_i(&o, fs.left_justified ? -fs.field_width : fs.field_width); }
+#endif
+    if (star_p) { npf_fmt_put_i(&o, (fs.prec_opt == NPF_FMT_SPEC_OPT_NONE) ? -1 : fs.prec); }
+    switch (kind) {
+      case NPF_ARG_CHAR:
+      case NPF_ARG_INT: npf_fmt_put_i(&o, a.i); break;
+      case NPF_ARG_UINT: npf_fmt_put_u(&o, a.u); break;
+      case NPF_ARG_PTR: npf_fmt_put_u(&o, (npf_arg_uint_t)(uintptr_t)a.p); break;
+      case NPF_ARG_STR: {
+        char const *const str = (char const *)a.p;
+        int len = 0;
+        while (str && ((fs.prec_opt == NPF_FMT_SPEC_OPT_NONE) || (len < fs.prec)) &&
+               str[len]) {
+          ++len;
+        }
+        npf_fmt_put_u(&o, (npf_arg_uint_t)len);
+        for (int i = 0; i < len; ++i) { pc(str[i], pc_ctx); }
+        o.n += len;
+      } break;
+#if NANOPRINTF_USE_FLOAT_FORMAT_SPECIFIERS == 1
+      case NPF_ARG_REAL: {
+        npf_real_bin_t const bits = npf_real_to_int_rep(a.r);
+        for (int i = 0; i < (int)sizeof(npf_real_t); ++i) {
+          pc((int)((bits >> (8 * i)) & 0xFFu), pc_ctx);
+        }
+        o.n += (int)sizeof(npf_real_t);
+      } break;
+#endif
+      default: break;
+    }
+    cur = end;
+  }
+  va_end(args);
+  return o.n;
+}
+
+int npf_fmt_send_(npf_putc pc, void *pc_ctx, char const *fmt, ...) {
+  va_list val;
+  va_start(val, fmt);
+  int const rv = npf_fmt_vsend(pc, pc_ctx, fmt, val);
+  va_end(val);
+  return rv;
+}
+
+typedef struct npf_fmt_in {
+  unsigned char const *p;
+  unsigned char const *end;
+} npf_fmt_in_t;
+
+// Reads a varint; 0 if the record ends first.
+static int npf_fmt_get_u(npf_fmt_in_t *in, npf_arg_uint_t *v) {
+  npf_arg_uint_t r = 0;
+  for (unsigned shift = 0; in->p < in->end; shift += 7u) {
+    unsigned const b = *in->p++;
+    if (shift < (8u * sizeof(r))) { r |= (npf_arg_uint_t)(b & 0x7Fu) << shift; }
+    if (!(b & 0x80u)) { *v = r; return 1; }
+  }
+  return 0;
+}
+
+static int npf_fmt_get_i(npf_fmt_in_t *in, npf_arg_int_t *v) {
+  npf_arg_uint_t u;
+  if (!npf_fmt_get_u(in, &u)) { return 0; }
+  *v = (u & 1u) ? (-(npf_arg_int_t)(u >> 1) - 1) : (npf_arg_int_t)(u >> 1);
+  return 1;
+}
+
+/* Reads one conversion's stars and value back into fs and a, the way npf_arg_take
+   would have left them. A string points into the record, so the precision is set
+   to its length: the bytes aren't NUL-terminated. 0 if the record ends first. */
+static int npf_fmt_get_arg(npf_fmt_in_t *in, npf_format_spec_t *fs, int kind,
+                           npf_arg_t *a) {
+  npf_arg_int_t i;
+  npf_arg_uint_t u;
+#if NANOPRINTF_USE_FIELD_WIDTH_FORMAT_SPECIFIERS == 1
+  if (fs->field_width_opt == NPF_FMT_SPEC_OPT_STAR) {
+    if (!npf_fmt_get_i(in, &i)) { return 0; }
+    if (i < 0) { fs->left_justified = '-'; i = -i; }
+    fs->field_width = (int)NPF_MIN(i, (npf_arg_int_t)NPF_FMT_NUM_MAX);
+    fs->field_width_opt = NPF_FMT_SPEC_OPT_LITERAL;
+  }
+#endif
+  if (fs->prec_opt == NPF_FMT_SPEC_OPT_STAR) {
+    if (!npf_fmt_get_i(in, &i)) { return 0; }
+    fs->prec = (int)NPF_MIN(i, (npf_arg_int_t)NPF_FMT_NUM_MAX);
+    fs->prec_opt = (i < 0) ? NPF_FMT_SPEC_OPT_NONE : NPF_FMT_SPEC_OPT_LITERAL;
+  }
+  a->u = 0;
+  switch (kind) {
+    case NPF_ARG_CHAR:
+    case NPF_ARG_INT: return npf_fmt_get_i(in, &a->i);
+    case NPF_ARG_UINT: return npf_fmt_get_u(in, &a->u);
+    case NPF_ARG_PTR:
+      if (!npf_fmt_get_u(in, &u)) { return 0; }
+      a->p = (void const *)(uintptr_t)u;
+      return 1;
+    case NPF_ARG_STR:
+      if (!npf_fmt_get_u(in, &u) || (u > (npf_arg_uint_t)(in->end - in->p))) { return 0; }
+      a->p = in->p;
+      in->p += u;
+      fs->prec = (int)u;
+      fs->prec_opt = NPF_FMT_SPEC_OPT_LITERAL;
+      return 1;
+#if NANOPRINTF_USE_FLOAT_FORMAT_SPECIFIERS == 1
+    case NPF_ARG_REAL: {
+      if ((in->end - in->p) < (ptrdiff_t)sizeof(npf_real_t)) { return 0; }
+      npf_real_bin_t bits = 0;
+      for (int k = (int)sizeof(npf_real_t); k--;) {
+        bits = (npf_real_bin_t)((bits << 8) | in->p[k]);
+      }
+      in->p += sizeof(npf_real_t);
+      a->r = npf_real_from_int_rep(bits);
+      return 1;
+    }
+#endif
+    default: return 1;
+  }
+}
+
+int npf_fmt_read_id(void const *rec, int len, unsigned long *id) {
+  npf_fmt_in_t in;
+  npf_arg_uint_t u;
+  in.p = (unsigned char const *)rec;
+  in.end = in.p + ((rec && (len > 0)) ? len : 0);
+  if (!npf_fmt_get_u(&in, &u)) { return 0; }
+  *id = (unsigned long)u;
+  return (int)(in.p - (unsigned char const *)rec);
+}
+
+int npf_fmt_render(npf_putc pc, void *pc_ctx, char const *fmt, void const *args,
+                   int len) {
+  npf_fmt_in_t in;
+  in.p = (unsigned char const *)args;
+  in.end = in.p + ((args && (len > 0)) ? len : 0);
+  int n = 0;
+  for (char const *cur = fmt; *cur;) {
+    npf_format_spec_t fs;
+    char const *const end = (*cur == '%') ? npf_parse_format_spec_end(cur, &fs) : NULL;
+    if (!end) { pc(*cur++, pc_ctx); ++n; continue; }
+    int const kind = npf_arg_kind(&fs);
+    npf_arg_t a;
+    if ((kind < 0) || !npf_fmt_get_arg(&in, &fs, kind, &a)) { break; }
+    n += npf_arg_put(pc, pc_ctx, &fs, kind, end[-1], &a);
+    cur = end;
+  }
+  return n;
+}
+#endif
+
+#if NANOPRINTF_USE_DEFERRED_LOG == 1
+/* Record layout: its size in two bytes, the format pointer, then per conversion its
+   star width and precision as ints if it has them, then its value. Integers take
+   as many bytes as the spec's type, low byte first; %c takes one. Pointers and
+   floats are their bytes in memory, and a string is copied with its NUL. Only the
+   device reads a record back, so nothing here is portable between builds. */
+typedef struct npf_ring_out {
+  npf_ring_t *r;
+  unsigned at; // where this record starts
+  unsigned len;
+  int full;
+} npf_ring_out_t;
+
+static unsigned npf_ring_wrap(npf_ring_t const *r, unsigned i) {
+  return (i >= r->cap) ? (i - r->cap) : i;
+}
+
+void npf_ring_init(npf_ring_t *ring, void *buf, unsigned size) {
+  ring->buf = (unsigned char *)buf;
+  ring->cap = size;
+  ring->tail = 0;
+  ring->used = 0;
+  ring->lost = 0;
+}
+
+// The most bytes one record can take: the whole ring, up to what its size can hold.
+static unsigned npf_ring_max(npf_ring_t const *r) { return NPF_MIN(r->cap, 0xFFFFu); }
+
+/* Makes room for n more bytes of o's record by overwriting the oldest records; 0,
+   and the record ends, if they wouldn't fit even with the ring to itself. That is
+   checked first, so a value that can't be stored costs no history. */
+static int npf_ring_room(npf_ring_out_t *o, unsigned n) {
+  npf_ring_t *const r = o->r;
+  if (o->full || (n > (npf_ring_max(r) - o->len))) { o->full = 1; return 0; }
+  while ((r->cap - r->used) < n) {
+    unsigned const sz = r->buf[r->tail] | (r->buf[npf_ring_wrap(r, r->tail + 1)] << 8);
+    r->tail = npf_ring_wrap(r, r->tail + sz);
+    r->used -= sz;
+    ++r->lost;
+  }
+  return 1;
+}
+
+// Appends n bytes to o's record, all or none. One reservation per value keeps
+// the byte loop free of the bookkeeping.
+static void npf_ring_write(npf_ring_out_t *o, void const *p, unsigned n) {
+  if (!npf_ring_room(o, n)) { return; }
+  unsigned char *const buf = o->r->buf;
+  unsigned const cap = o->r->cap;
+  unsigned at = npf_ring_wrap(o->r, o->at + o->len);
+  unsigned char const *b = (unsigned char const *)p;
+  for (unsigned i = 0; i < n; ++i) {
+    buf[at] = b[i];
+    if (++at == cap) { at = 0; }
+  }
+  o->len += n;
+  o->r->used += n;
+}
+
+static void npf_ring_write_u(npf_ring_out_t *o, npf_arg_uint_t v, int n) {
+  unsigned char le[sizeof(npf_arg_uint_t)];
+  for (int i = 0; i < n; ++i, v >>= 8) { le[i] = (unsigned char)(v & 0xFFu); }
+  npf_ring_write(o, le, (unsigned)n);
+}
+
+// The bytes the integer type fs reads takes.
+static int npf_ring_int_size(npf_format_spec_t const *fs) {
+  switch (fs->length_modifier) {
+    case NPF_FMT_SPEC_LEN_MOD_LONG: return (int)sizeof(long);
+#if NANOPRINTF_USE_LARGE_FORMAT_SPECIFIERS == 1
+    case NPF_FMT_SPEC_LEN_MOD_LARGE_LONG_LONG: return (int)sizeof(long long);
+    case NPF_FMT_SPEC_LEN_MOD_LARGE_INTMAX: return (int)sizeof(intmax_t);
+    case NPF_FMT_SPEC_LEN_MOD_LARGE_SIZET: return (int)sizeof(size_t);
+    case NPF_FMT_SPEC_LEN_MOD_LARGE_PTRDIFFT: return (int)sizeof(ptrdiff_t);
+#endif
+#if NANOPRINTF_USE_SMALL_FORMAT_SPECIFIERS == 1
+    case NPF_FMT_SPEC_LEN_MOD_SHORT: return (int)sizeof(short);
+    case NPF_FMT_SPEC_LEN_MOD_CHAR: return 1;
+#endif
+    default: return (int)sizeof(int);
+  }
+}
+
+int npf_ring_vlog(npf_ring_t *ring, char const *format, va_list vlist) {
+  npf_ring_out_t o;
+  o.r = ring;
+  o.at = npf_ring_wrap(ring, ring->tail + ring->used);
+  o.len = 0;
+  o.full = 0;
+  va_list args;
+  va_copy(args, vlist); // taken by address below, which a parameter can't always be
+  npf_ring_write_u(&o, 0, 2); // the size, once it's known
+  npf_ring_write(&o, &format, sizeof(format));
+  for (char const *cur = format; *cur && !o.full;) {
+    npf_format_spec_t fs;
+    char const *const end = (*cur == '%') ? npf_parse_format_spec_end(cur, &fs) : NULL;
+    if (!end) { ++cur; continue; }
+    int const kind = npf_arg_kind(&fs);
+    if (kind < 0) { break; } // the dump stops at the same conversion
+#if NANOPRINTF_USE_FIELD_WIDTH_FORMAT_SPECIFIERS == 1
+    char const star_w = (fs.field_width_opt == NPF_FMT_SPEC_OPT_STAR);
+#endif
+#if NANOPRINTF_USE_PRECISION_FORMAT_SPECIFIERS == 1
+    char const star_p = (fs.prec_opt == NPF_FMT_SPEC_OPT_STAR);
+#endif
+    npf_arg_t a;
+    npf_arg_take(&fs, &args, kind, &a);
+#if NANOPRINTF_USE_FIELD_WIDTH_FORMAT_SPECIFIERS == 1
+    if (star_w) {
+      int const w = fs.left_justified ? -fs.field_width : fs.field_width;
+      npf_ring_write_u(&o, (npf_arg_uint_t)(npf_arg_int_t)w, (int)sizeof(int));
+    }
+#endif
+#if NANOPRINTF_USE_PRECISION_FORMAT_SPECIFIERS == 1
+    if (star_p) {
+      int const p = (fs.prec_opt == NPF_FMT_SPEC_OPT_NONE) ? -1 : fs.prec;
+      npf_ring_write_u(&o, (npf_arg_uint_t)(npf_arg_int_t)p, (int)sizeof(int));
+    }
+#endif
+    switch (kind) {
+      case NPF_ARG_CHAR: npf_ring_write_u(&o, (npf_arg_uint_t)a.i, 1); break;
+      case NPF_ARG_INT: npf_ring_write_u(&o, (npf_arg_uint_t)a.i, npf_ring_int_size(&fs)); break;
+      case NPF_ARG_UINT: npf_ring_write_u(&o, a.u, npf_ring_int_size(&fs)); break;
+      case NPF_ARG_PTR: npf_ring_write(&o, &a.p, sizeof(a.p)); break;
+      case NPF_ARG_STR: { // NULL prints nothing, so it's stored as ""
+        char const *const str = a.p ? (char const *)a.p : "";
+        // Cut to what the record could still hold with the ring to itself, NUL
+        // included, so a long string keeps its head rather than ending the record.
+        unsigned const room = npf_ring_max(ring) - o.len;
+        unsigned len = 0;
+#if NANOPRINTF_USE_PRECISION_FORMAT_SPECIFIERS == 1
+        while (((len + 1u) < room) &&
+               ((fs.prec_opt == NPF_FMT_SPEC_OPT_NONE) || (len < (unsigned)fs.prec)) &&
+               str[len]) {
+          ++len;
+        }
+#else
+        while (((len + 1u) < room) && str[len]) { ++len; }
+#endif
+        npf_ring_write(&o, str, len);
+        npf_ring_write_u(&o, 0, 1);
+      } break;
+#if NANOPRINTF_USE_FLOAT_FORMAT_SPECIFIERS == 1
+      case NPF_ARG_REAL: npf_ring_write(&o, &a.r, sizeof(a.r)); break;
+#endif
+      default: break;
+    }
+    cur = end;
+  }
+  va_end(args);
+  if (o.len < (2u + sizeof(format))) { // no room for even the header
+    ring->used -= o.len;
+    return 0;
+  }
+  ring->buf[o.at] = (unsigned char)(o.len & 0xFFu);
+  ring->buf[npf_ring_wrap(ring, o.at + 1)] = (unsigned char)(o.len >> 8);
+  return (int)o.len;
+}
+
+int npf_ring_log_(npf_ring_t *ring, char const *format, ...) {
+  va_list val;
+  va_start(val, format);
+  int const rv = npf_ring_vlog(ring, format, val);
+  va_end(val);
+  return rv;
+}
+
+typedef struct npf_ring_in {
+  unsigned char const *p;
+  unsigned char const *end;
+} npf_ring_in_t;
+
+// Reads an n-byte integer, sign-extending it if sign; 0 if the record ends first.
+static int npf_ring_get_u(npf_ring_in_t *in, int n, int sign, npf_arg_uint_t *v) {
+  if ((in->end - in->p) < n) { return 0; }
+  npf_arg_uint_t u = 0;
+  for (int i = n; i--;) { u = (u << 8) | (npf_arg_uint_t)in->p[i]; }
+  if (sign && (n < (int)sizeof(u)) && (in->p[n - 1] & 0x80u)) {
+    u |= ~(npf_arg_uint_t)0 << (8 * n);
+  }
+  in->p += n;
+  *v = u;
+  return 1;
+}
+
+static int npf_ring_get_bytes(npf_ring_in_t *in, void *p, int n) {
+  if ((in->end - in->p) < n) { return 0; }
+  for (unsigned char *b = (unsigned char *)p; n--; ++b) { *b = *in->p++; }
+  return 1;
+}
+
+/* Reads one conversion's stars and value back into fs and a, the way npf_arg_take
+   would have left them. 0 if the record ends first. */
+static int npf_ring_get_arg(npf_ring_in_t *in, npf_format_spec_t *fs, int kind,
+                            npf_arg_t *a) {
+  npf_arg_uint_t u;
+#if NANOPRINTF_USE_FIELD_WIDTH_FORMAT_SPECIFIERS == 1
+  if (fs->field_width_opt == NPF_FMT_SPEC_OPT_STAR) {
+    if (!npf_ring_get_u(in, (int)sizeof(int), 1, &u)) { return 0; }
+    int w = (int)(npf_arg_int_t)u;
+    if (w < 0) { fs->left_justified = '-'; w = -w; }
+    fs->field_width = w;
+    fs->field_width_opt = NPF_FMT_SPEC_OPT_LITERAL;
+  }
+#endif
+#if NANOPRINTF_USE_PRECISION_FORMAT_SPECIFIERS == 1
+  if (fs->prec_opt == NPF_FMT_SPEC_OPT_STAR) {
+    if (!npf_ring_get_u(in, (int)sizeof(int), 1, &u)) { return 0; }
+    fs->prec = (int)(npf_arg_int_t)u;
+    fs->prec_opt = (fs->prec < 0) ? NPF_FMT_SPEC_OPT_NONE : NPF_FMT_SPEC_OPT_LITERAL;
+  }
+#endif
+  a->u = 0;
+  switch (kind) {
+    case NPF_ARG_CHAR:
+      if (!npf_ring_get_u(in, 1, 0, &u)) { return 0; }
+      a->i = (npf_arg_int_t)u;
+      return 1;
+    case NPF_ARG_INT:
+      if (!npf_ring_get_u(in, npf_ring_int_size(fs), 1, &u)) { return 0; }
+      a->i = (npf_arg_int_t)u;
+      return 1;
+    case NPF_ARG_UINT: return npf_ring_get_u(in, npf_ring_int_size(fs), 0, &a->u);
+    case NPF_ARG_PTR: return npf_ring_get_bytes(in, &a->p, (int)sizeof(a->p));
+    case NPF_ARG_STR:
+      for (unsigned char const *s = in->p; s < in->end; ++s) {
+        if (!*s) { a->p = in->p; in->p = s + 1; return 1; }
+      }
+      return 0;
+#if NANOPRINTF_USE_FLOAT_FORMAT_SPECIFIERS == 1
+    case NPF_ARG_REAL: return npf_ring_get_bytes(in, &a->r, (int)sizeof(a->r));
+#endif
+    default: return 1;
+  }
+}
+
+static int npf_ring_render(npf_putc pc, void *pc_ctx, char const *fmt, npf_ring_in_t *in) {
+  int n = 0;
+  for (char const *cur = fmt; *cur;) {
+    npf_format_spec_t fs;
+    char const *const end = (*cur == '%') ? npf_parse_format_spec_end(cur, &fs) : NULL;
+    if (!end) { pc(*cur++, pc_ctx); ++n; continue; }
+    int const kind = npf_arg_kind(&fs);
+    npf_arg_t a;
+    if ((kind < 0) || !npf_ring_get_arg(in, &fs, kind, &a)) { break; }
+    n += npf_arg_put(pc, pc_ctx, &fs, kind, end[-1], &a);
+    cur = end;
+  }
+  return n;
+}
+
+static void npf_ring_reverse(unsigned char *lo, unsigned char *hi) {
+  for (; (hi - lo) > 1; ++lo) {
+    unsigned char const t = *lo;
+    *lo = *--hi;
+    *hi = t;
+  }
+}
+
+int npf_ring_dump(npf_ring_t *ring, npf_putc pc, void *pc_ctx) {
+  unsigned char *const buf = ring->buf;
+  if (ring->tail) { // rotate, so that no record wraps
+    npf_ring_reverse(buf, buf + ring->tail);
+    npf_ring_reverse(buf + ring->tail, buf + ring->cap);
+    npf_ring_reverse(buf, buf + ring->cap);
+    ring->tail = 0;
+  }
+  int n = 0;
+  unsigned const hdr = 2u + (unsigned)sizeof(char const *);
+  for (unsigned at = 0; (ring->used - at) >= hdr;) {
+    unsigned const size = buf[at] | (buf[at + 1] << 8);
+    if ((size < hdr) || (size > (ring->used - at))) { break; }
+    char const *fmt;
+    npf_ring_in_t in;
+    in.p = buf + at + 2;
+    in.end = buf + at + size;
+    npf_ring_get_bytes(&in, &fmt, (int)sizeof(fmt));
+    n += npf_ring_render(pc, pc_ctx, fmt, &in);
+    at += size;
+  }
+  return n;
+}
+#endif
+
+#if NANOPRINTF_USE_DEDUP_SINK == 1
+void npf_dedup_init(npf_dedup_t *dd, npf_putc pc, void *pc_ctx, unsigned window) {
+  dd->pc = pc;
+  dd->pc_ctx = pc_ctx;
+  dd->window = window;
+  dd->repeats = 0;
+  dd->fmt = NULL;
+  dd->key = 0;
+}
+
+// FNV-1a, 64-bit where unsigned long can hold it.
+#if ULONG_MAX > 0xFFFFFFFFu
+  #define NPF_DEDUP_BASIS 14695981039346656037ul
+  #define NPF_DEDUP_PRIME 1099511628211ul
+#else
+  #define NPF_DEDUP_BASIS 2166136261ul
+  #define NPF_DEDUP_PRIME 16777619ul
+#endif
+
+static unsigned long npf_dedup_mix(unsigned long h, void const *p, unsigned n) {
+  unsigned char const *const b = (unsigned char const *)p;
+  for (unsigned i = 0; i < n; ++i) { h = (h ^ b[i]) * NPF_DEDUP_PRIME; }
+  return h;
+}
+
+/* Hashes what each conversion takes, as npf_arg_take holds it, into *key; 0 if a
+   conversion can't be taken, since its arguments couldn't be told apart. */
+static int npf_dedup_key(char const *format, va_list vlist, unsigned long *key) {
+  unsigned long h = NPF_DEDUP_BASIS;
+  int ok = 1;
+  va_list args;
+  va_copy(args, vlist); // taken by address below, which a parameter can't always be
+  for (char const *cur = format; *cur;) {
+    npf_format_spec_t fs;
+    char const *const end = (*cur == '%') ? npf_parse_format_spec_end(cur, &fs) : NULL;
+    if (!end) { ++cur; continue; }
+    int const kind = npf_arg_kind(&fs);
+    if (kind < 0) { ok = 0; break; }
+#if NANOPRINTF_USE_FIELD_WIDTH_FORMAT_SPECIFIERS == 1
+    char const star_w = (fs.field_width_opt == NPF_FMT_SPEC_OPT_STAR);
+#endif
+#if NANOPRINTF_USE_PRECISION_FORMAT_SPECIFIERS == 1
+    char const star_p = (fs.prec_opt == NPF_FMT_SPEC_OPT_STAR);
+#endif
+    npf_arg_t a;
+    npf_arg_take(&fs, &args, kind, &a);
+    // Literal widths and precisions are part of the format, which the pointer keys.
+#if NANOPRINTF_USE_FIELD_WIDTH_FORMAT_SPECIFIERS == 1
+    if (star_w) {
+      int const w = fs.left_justified ? -fs.field_width : fs.field_width;
+      h = npf_dedup_mix(h, &w, sizeof(w));
+    }
+#endif
+#if NANOPRINTF_USE_PRECISION_FORMAT_SPECIFIERS == 1
+    if (star_p) {
+      int const p = (fs.prec_opt == NPF_FMT_SPEC_OPT_NONE) ? -1 : fs.prec;
+      h = npf_dedup_mix(h, &p, sizeof(p));
+    }
+#endif
+    switch (kind) {
+      case NPF_ARG_CHAR:
+      case NPF_ARG_INT: h = npf_dedup_mix(h, &a.i, sizeof(a.i)); break;
+      case NPF_ARG_UINT: h = npf_dedup_mix(h, &a.u, sizeof(a.u)); break;
+      case NPF_ARG_PTR: h = npf_dedup_mix(h, &a.p, sizeof(a.p)); break;
+      case NPF_ARG_STR: { // the bytes it prints, then a NUL to end them
+        char const *const str = a.p ? (char const *)a.p : ""; // NULL prints nothing
+        unsigned len = 0;
+#if NANOPRINTF_USE_PRECISION_FORMAT_SPECIFIERS == 1
+        while (((fs.prec_opt == NPF_FMT_SPEC_OPT_NONE) || (len < (unsigned)fs.prec)) &&
+               str[len]) {
+          ++len;
+        }
+#else
+        while (str[len]) { ++len; }
+#endif
+        h = npf_dedup_mix(npf_dedup_mix(h, str, len), "", 1);
+      } break;
+#if NANOPRINTF_USE_FLOAT_FORMAT_SPECIFIERS == 1
+      case NPF_ARG_REAL: h = npf_dedup_mix(h, &a.r, sizeof(a.r)); break;
+#endif
+      default: break;
+    }
+    cur = end;
+  }
+  va_end(args);
+  *key = h;
+  return ok;
+}
+
+int npf_dedup_flush(npf_dedup_t *dd) {
+  unsigned const n = dd->repeats;
+  if (!n) { return 0; }
+  dd->repeats = 0;
+  return npf_pprintf_(dd->pc, dd->pc_ctx, "last message repeated %u times\n", n);
+}
+
+int npf_dedup_vpprintf(npf_dedup_t *dd, char const *format, va_list vlist) {
+  unsigned long key;
+  int const ok = npf_dedup_key(format, vlist, &key);
+  if (ok && (format == dd->fmt) && (key == dd->key)) {
+    if (++dd->repeats != dd->window) { return 0; }
+    return npf_dedup_flush(dd);
+  }
+  int const n = npf_dedup_flush(dd);
+  dd->fmt = ok ? format : NULL;
+  dd->key = key;
+  return n + npf_vpprintf(dd->pc, dd->pc_ctx, format, vlist);
+}
+
+int npf_dedup_pprintf_(npf_dedup_t *dd, char const *format, ...) {
+  va_list val;
+  va_start(val, format);
+  int const rv = npf_dedup_vpprintf(dd, format, val);
+  va_end(val);
+  return rv;
+}
+#endif
+
 #if NPF_HAVE_GCC_WARNING_PRAGMAS
   #pragma GCC diagnostic pop
 #endif
@@ -2556,7 +2556,9 @@ int NPF_TEST_FUNC(void) {
     NPF_TEST("x", "%+c", 'x');
 
     /* unknown flag (non-standard) */
+#if NANOPRINTF_USE_FIXED_POINT_FORMAT_SPECIFIERS == 0
     NPF_TEST("%kmarco", "%kmarco");
+#endif
 
     /* ===== field width never truncates ===== */
 #if NANOPRINTF_USE_FIELD_WIDTH_FORMAT_SPECIFIERS == 1
@@ -0,0 +1,117 @@
+/*
+  Instruction-count corpus, run on an emulated Cortex-M by cycle_report.py. See
+  npf_cortex_m.h for how ticks become instructions. QEMU does not model pipelines
+  or wait states, so what comes out is instructions retired, not cycles: a proxy
+  that is exact and repeatable, which is what a table comparing configurations
+  needs.
+
+  Each line of output is one of:
+    CAL <spin count> <ticks>
+    NUL <ticks>                     an empty format, the call overhead
+    CONV <specifier> <ticks> <fmt>  one conversion from the corpus
+    DONE
+*/
+
+#define NANOPRINTF_IMPLEMENTATION
+#include "nanoprintf.h"
+
+#include "npf_cortex_m.h"
+
+#include <limits.h>
+
+/* fmt is captured inside __VA_ARGS__, as in conformance.c. The conversion is
+   measured by itself; formatting the report line comes after the second read. */
+#define NPF_BENCH(SPEC, ...) do { \
+    uint32_t const t0_ = ticks(); \
+    npf_pprintf(null_putc, NULL, __VA_ARGS__); \
+    uint32_t const t1_ = ticks(); \
+    npf_snprintf(line, sizeof line, " %u ", elapsed(t0_, t1_)); \
+    put_s("CONV " SPEC); put_s(line); put_s(NPF_BENCH_FMT(__VA_ARGS__, 0)); \
+    put_s("\n"); \
+  } while (0)
+#define NPF_BENCH_FMT(FMT, ...) FMT
+
+#if NANOPRINTF_USE_STRUCTURED_LOG == 1
+// One npf_log record through ENC; SPEC names the encoder.
+#define NPF_BENCH_LOG(SPEC, ENC, ...) do { \
+    npf_log_sink_t const sink_ = { null_putc, NULL, (ENC) }; \
+    uint32_t const t0_ = ticks(); \
+    npf_log(&sink_, __VA_ARGS__); \
+    uint32_t const t1_ = ticks(); \
+    npf_snprintf(line, sizeof line, " %u ", elapsed(t0_, t1_)); \
+    put_s("CONV " SPEC); put_s(line); put_s(NPF_BENCH_FMT(__VA_ARGS__, 0)); \
+    put_s("\n"); \
+  } while (0)
+#endif
+
+int main(void) {
+  npf_cortex_m_start();
+
+  { uint32_t const t0 = ticks();
+    npf_pprintf(null_putc, NULL, "");
+    uint32_t const t1 = ticks();
+    npf_snprintf(line, sizeof line, "NUL %u\n", elapsed(t0, t1));
+    put_s(line); }
+
+  NPF_BENCH("%c", "%c", 'A');
+  NPF_BENCH("%s", "%s", "hello, world");
+  NPF_BENCH("%d", "%d", 0);
+  NPF_BENCH("%d", "%d", -1);
+  NPF_BENCH("%d", "%d", 12345);
+  NPF_BENCH("%d", "%d", INT_MIN);
+  NPF_BENCH("%u", "%u", 4294967295u);
+  NPF_BENCH("%x", "%x", 0xDEADBEEFu);
+  NPF_BENCH("%o", "%o", 0777u);
+  NPF_BENCH("%p", "%p", (void *)&line);
+#if NANOPRINTF_USE_FIELD_WIDTH_FORMAT_SPECIFIERS == 1
+  NPF_BENCH("%d", "%08d", -42);
+#endif
+#if NANOPRINTF_USE_BINARY_FORMAT_SPECIFIERS == 1
+  NPF_BENCH("%b", "%b", 0x5A5Au);
+  NPF_BENCH("%b", "%b", 0xFFFFFFFFu);
+#endif
+#if NANOPRINTF_USE_LARGE_FORMAT_SPECIFIERS == 1
+  NPF_BENCH("%llu", "%llu", 18446744073709551615ull);
+  NPF_BENCH("%llx", "%llx", 0x0123456789ABCDEFull);
+#endif
+#if NANOPRINTF_USE_FLOAT_FORMAT_SPECIFIERS == 1
+  NPF_BENCH("%f", "%f", 0.0);
+  NPF_BENCH("%f", "%f", 1.5);
+  NPF_BENCH("%f", "%f", 3.14159265);
+  NPF_BENCH("%f", "%f", 1234567.125);
+  NPF_BENCH("%f", "%f", 1e-5);
+  NPF_BENCH("%f", "%f", -2.5e10);
+#endif
+#if NANOPRINTF_USE_FLOAT_SCI_FORMAT_SPECIFIER == 1
+  NPF_BENCH("%e", "%e", 0.0);
+  NPF_BENCH("%e", "%e", 1.5);
+  NPF_BENCH("%e", "%e", 3.14159265);
+  NPF_BENCH("%e", "%e", 1234567.125);
+  NPF_BENCH("%e", "%e", 1e-5);
+  NPF_BENCH("%e", "%e", -2.5e10);
+#endif
+#if NANOPRINTF_USE_FLOAT_SHORTEST_FORMAT_SPECIFIER == 1
+  NPF_BENCH("%g", "%g", 0.0);
+  NPF_BENCH("%g", "%g", 1.5);
+  NPF_BENCH("%g", "%g", 3.14159265);
+  NPF_BENCH("%g", "%g", 1234567.125);
+  NPF_BENCH("%g", "%g", 1e-5);
+  NPF_BENCH("%g", "%g", -2.5e10);
+#endif
+#if NANOPRINTF_USE_FLOAT_HEX_FORMAT_SPECIFIER == 1
+  NPF_BENCH("%a", "%a", 0.0);
+  NPF_BENCH("%a", "%a", 1.5);
+  NPF_BENCH("%a", "%a", 3.14159265);
+  NPF_BENCH("%a", "%a", -2.5e10);
+#endif
+
+#if NANOPRINTF_USE_STRUCTURED_LOG == 1
+  // The same record as text and as fields; CBOR never converts to decimal.
+  NPF_BENCH_LOG("log-text", NPF_LOG_TEXT, "temp=%.2f id=%u seq=%d", 21.375, 48879u, -42);
+  NPF_BENCH_LOG("log-json", NPF_LOG_JSON, "temp=%.2f id=%u seq=%d", 21.375, 48879u, -42);
+  NPF_BENCH_LOG("log-cbor", NPF_LOG_CBOR, "temp=%.2f id=%u seq=%d", 21.375, 48879u, -42);
+#endif
+
+  put_s("DONE\n");
+  return 0;
+}
@@ -0,0 +1,286 @@
+"""Count the instructions nanoprintf's conversions cost on an emulated Cortex-M.
+
+Needs arm-none-eabi-gcc and qemu-system-arm. The corpus in cycle_report.c runs
+under -icount, the way avr_int16.py runs its probe under qemu-system-avr, so the
+counts are deterministic and can sit in the README next to the size tables.
+QEMU retires instructions without modelling pipelines or flash wait states, so
+the numbers are instructions, not cycles: exact for comparing configurations,
+an underestimate of wall-clock time on real silicon.
+"""
+
+import argparse
+import pathlib
+import re
+import subprocess
+import sys
+import tempfile
+
+_TIMEOUT_SEC = 120
+
+# Every virtual instruction takes 2**shift ns. Large enough that a SysTick tick
+# is shorter than an instruction on both machines, so no instruction goes uncounted.
+_ICOUNT = "shift=7,align=off,sleep=off"
+
+# platform: (gcc -mcpu flags, qemu machine). microbit is the only Cortex-M0 QEMU
+# emulates; both machines have flash at 0 and RAM at 0x20000000.
+_PLATFORMS = {
+    "cm0": (["-mcpu=cortex-m0"], "microbit"),
+    "cm4": (["-mcpu=cortex-m4", "-mfloat-abi=hard", "-mfpu=fpv4-sp-d16"], "mps2-an386"),
+}
+
+_LINKER_SCRIPT = """\
+MEMORY {
+  FLASH (rx) : ORIGIN = 0x00000000, LENGTH = 256K
+  RAM (rwx)  : ORIGIN = 0x20000000, LENGTH = 16K
+}
+SECTIONS {
+  .text : { KEEP(*(.vectors)) *(.text*) *(.rodata*) } > FLASH
+  __data_load = LOADADDR(.data);
+  .data : { __data_start = .; *(.data*) . = ALIGN(4); __data_end = .; } > RAM AT > FLASH
+  .bss (NOLOAD) : { __bss_start = .; *(.bss*) *(COMMON) . = ALIGN(4); __bss_end = .; } > RAM
+  __stack_top = ORIGIN(RAM) + LENGTH(RAM);
+}
+"""
+
+_MANDATORY = (
+    "FIELD_WIDTH_FORMAT_SPECIFIERS",
+    "PRECISION_FORMAT_SPECIFIERS",
+    "FLOAT_FORMAT_SPECIFIERS",
+    "SMALL_FORMAT_SPECIFIERS",
+    "LARGE_FORMAT_SPECIFIERS",
+    "BINARY_FORMAT_SPECIFIERS",
+    "WRITEBACK_FORMAT_SPECIFIERS",
+    "ALT_FORM_FLAG",
+)
+
+
+def _flags(**on: int) -> list[str]:
+    """The -D list for a configuration; keyword names drop the NANOPRINTF_USE_ prefix."""
+    mandatory = [f"-DNANOPRINTF_USE_{f}={int(on.pop(f, 0))}" for f in _MANDATORY]
+    return mandatory + [f"-DNANOPRINTF_USE_{f}={int(v)}" for f, v in on.items()]
+
+
+_EVERYTHING = {
+    "FIELD_WIDTH_FORMAT_SPECIFIERS": 1,
+    "PRECISION_FORMAT_SPECIFIERS": 1,
+    "FLOAT_FORMAT_SPECIFIERS": 1,
+    "SMALL_FORMAT_SPECIFIERS": 1,
+    "LARGE_FORMAT_SPECIFIERS": 1,
+    "BINARY_FORMAT_SPECIFIERS": 1,
+    "ALT_FORM_FLAG": 1,
+    "FLOAT_SCI_FORMAT_SPECIFIER": 1,
+    "FLOAT_SHORTEST_FORMAT_SPECIFIER": 1,
+    "FLOAT_HEX_FORMAT_SPECIFIER": 1,
+}
+
+# The README columns: (heading, platform, flags). Each is the size table's
+# "Everything" row plus whichever flag trades size for speed on that core.
+_README_CONFIGS = [
+    ("Cortex-M0", "cm0", _flags(**_EVERYTHING)),
+    ("Cortex-M0, division-free", "cm0",
+     _flags(**_EVERYTHING, DIVISION_FREE_CONVERSION=1)),
+    ("Cortex-M4", "cm4", _flags(**_EVERYTHING)),
+    ("Cortex-M4, single-precision", "cm4",
+     _flags(**_EVERYTHING, FLOAT_SINGLE_PRECISION=1)),
+]
+
+# The per-platform breakdown adds %f on its own, which compiles the fused
+# generator instead of the one %e and %g share, and a 64-bit intermediate.
+_DETAIL_CONFIGS = [
+    ("Everything", _flags(**_EVERYTHING)),
+    ("Everything, division-free", _flags(**_EVERYTHING, DIVISION_FREE_CONVERSION=1)),
+    ("Everything, single-precision", _flags(**_EVERYTHING, FLOAT_SINGLE_PRECISION=1)),
+    ("Field width + precision + %f", _flags(
+        FIELD_WIDTH_FORMAT_SPECIFIERS=1, PRECISION_FORMAT_SPECIFIERS=1,
+        FLOAT_FORMAT_SPECIFIERS=1, SMALL_FORMAT_SPECIFIERS=1, ALT_FORM_FLAG=1)),
+    ("Everything, uint64_t intermediate",
+     [*_flags(**_EVERYTHING), "-DNANOPRINTF_CONVERSION_FLOAT_TYPE=uint64_t"]),
+    ("Everything, structured log", _flags(**_EVERYTHING, STRUCTURED_LOG=1)),
+]
+
+_README_BEGIN = "<!-- BEGIN CYCLE REPORT (generated by tests/cycle_report.py --update-readme) -->"
+_README_END = "<!-- END CYCLE REPORT -->"
+
+
+def _parse_args() -> argparse.Namespace:
+    """Parse and validate command-line arguments."""
+    parser = argparse.ArgumentParser()
+    parser.add_argument(
+        "-p",
+        "--platform",
+        choices=tuple(_PLATFORMS),
+        help="print per-conversion instruction counts for this target platform",
+    )
+    parser.add_argument(
+        "--update-readme",
+        action="store_true",
+        help="rewrite the README instruction-count table from the current source",
+    )
+    args = parser.parse_args()
+    if not (args.platform or args.update_readme):
+        parser.error("one of -p/--platform or --update-readme is required")
+    if args.platform and args.update_readme:
+        parser.error("-p/--platform cannot be combined with --update-readme")
+    return args
+
+
+def _git_root() -> pathlib.Path:
+    """Return the root of the current file git repository."""
+    cur = pathlib.Path(__file__).resolve()
+    while cur != cur.parent:
+        if (cur / ".git").exists():  # dir for a normal clone, file for a worktree
+            return cur
+        cur = cur.parent
+
+    msg = f"{__file__} not in git repo"
+    raise ValueError(msg)
+
+
+def run(
+    platform: str,
+    flags: list[str],
+    src: pathlib.Path | None = None,
+    timeout: int = _TIMEOUT_SEC,
+) -> str:
+    """Build src (default cycle_report.c) for platform + flags, run it under qemu,
+    return its output."""
+    cpu_flags, machine = _PLATFORMS[platform]
+    src = src or pathlib.Path(__file__).with_suffix(".c")
+
+    with tempfile.TemporaryDirectory() as temp_dir:
+        tmp = pathlib.Path(temp_dir)
+        (tmp / "bench.ld").write_text(_LINKER_SCRIPT)
+        elf = tmp / "bench.elf"
+
+        cc_cmd = [
+            "arm-none-eabi-gcc",
+            "-mthumb",
+            *cpu_flags,
+            "-Os",
+            "-std=c11",
+            "-Wall",
+            "-Wextra",
+            "-Werror",
+            "-Wno-format-zero-length",  # the empty format is the call-overhead baseline
+            "-ffreestanding",
+            "-nostartfiles",
+            f"-I{_git_root()}",
+            *flags,
+            "-T",
+            str(tmp / "bench.ld"),
+            "-o",
+            str(elf),
+            str(src),
+            "-lgcc",
+        ]
+        qemu_cmd = [
+            "qemu-system-arm",
+            "-machine",
+            machine,
+            "-kernel",
+            str(elf),
+            "-icount",
+            _ICOUNT,
+            "-nographic",
+            "-monitor",
+            "none",
+            "-serial",
+            "none",
+            "-semihosting-config",
+            "enable=on,target=native",
+        ]
+
+        print(" ".join(cc_cmd), flush=True)
+        subprocess.run(cc_cmd, check=True)
+        print(" ".join(qemu_cmd), flush=True)
+        out = subprocess.run(
+            qemu_cmd, stdout=subprocess.PIPE, timeout=timeout, check=True
+        ).stdout.decode(errors="replace")
+
+    if "DONE" not in out:
+        msg = f"{src.name} never reached its end:\n{out}"
+        raise RuntimeError(msg)
+    return out
+
+
+def ticks_per_instruction(out: str) -> float:
+    """The two calibration spins differ by exactly 20000 instructions, which gives the
+    ticks-per-instruction ratio without knowing either machine's clock."""
+    cal = {int(n): int(t) for n, t in re.findall(r"^CAL (\d+) (\d+)$", out, re.MULTILINE)}
+    return (cal[20000] - cal[10000]) / 20000
+
+
+def _instructions(out: str) -> list[tuple[str, str, int]]:
+    """Convert the corpus's tick deltas into (specifier, format, instructions).
+
+    The empty format's cost is subtracted, so each count is what the conversion
+    itself adds.
+    """
+    ticks_per_insn = ticks_per_instruction(out)
+    nul = int(re.search(r"^NUL (\d+)$", out, re.MULTILINE).group(1))
+
+    return [
+        (spec, fmt, round((int(t) - nul) / ticks_per_insn))
+        for spec, t, fmt in re.findall(r"^CONV (\S+) (\d+) (.*)$", out, re.MULTILINE)
+    ]
+
+
+def _per_specifier(rows: list[tuple[str, str, int]]) -> dict[str, int]:
+    """Mean instructions per specifier over its corpus entries, in corpus order."""
+    sums: dict[str, list[int]] = {}
+    for spec, _fmt, n in rows:
+        sums.setdefault(spec, []).append(n)
+    return {spec: round(sum(v) / len(v)) for spec, v in sums.items()}
+
+
+def _readme_table() -> str:
+    """Build the per-specifier instruction table, one column per configuration."""
+    columns = [_per_specifier(_instructions(run(p, f))) for _, p, f in _README_CONFIGS]
+    specs = list(dict.fromkeys(s for c in columns for s in c))
+
+    rows = [
+        "| Conversion | " + " | ".join(name for name, _, _ in _README_CONFIGS) + " |",
+        "|---|" + "--:|" * len(_README_CONFIGS),
+    ]
+    for spec in specs:
+        cells = " | ".join(str(c.get(spec, "-")) for c in columns)
+        rows.append(f"| `{spec}` | {cells} |")
+    return "\n".join(rows)
+
+
+def _readme() -> int:
+    """Rewrite the README instruction-count table from the current source."""
+    readme_path = _git_root() / "README.md"
+    text = readme_path.read_text(encoding="utf-8")
+    try:
+        start = text.index(_README_BEGIN) + len(_README_BEGIN)
+        stop = text.index(_README_END)
+    except ValueError:
+        print(f"README.md is missing the {_README_BEGIN} / {_README_END} markers",
+              file=sys.stderr)
+        return 1
+
+    updated = f"{text[:start]}\n\n{_readme_table()}\n\n{text[stop:]}"
+    readme_path.write_text(updated, encoding="utf-8", newline="\n")
+    print("Updated README instruction-count table.")
+    return 0
+
+
+def main() -> int:
+    """Entry point"""
+    args = _parse_args()
+
+    if args.update_readme:
+        return _readme()
+
+    for name, flags in _DETAIL_CONFIGS:
+        print(f'Configuration "{name}":')
+        for spec, fmt, n in _instructions(run(args.platform, flags)):
+            print(f"  {spec:<5} {fmt:<10} {n:>6}")
+        print()
+
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
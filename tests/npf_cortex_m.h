@@ -0,0 +1,85 @@
+#pragma once
+
+/* Bare-metal runtime shared by the programs cycle_report.py and wcet_float.py run
+   on qemu-system-arm. Include after nanoprintf.h; the including file defines main.
+
+   qemu runs them with -icount, which advances the virtual clock by a fixed amount
+   per retired instruction, so SysTick ticks are a deterministic function of the
+   instruction count. The programs only report raw tick deltas; the scripts turn
+   them into instructions with the calibration spins below, which retire a known
+   number of instructions each.
+
+   Output goes through semihosting, which is also how the run ends. Every program
+   starts with two calibration lines, "CAL <spin count> <ticks>", and ends with
+   "DONE". */
+
+#include <stdint.h>
+
+#define NPF_SYST_CSR (*(uint32_t volatile *)0xE000E010u)
+#define NPF_SYST_RVR (*(uint32_t volatile *)0xE000E014u)
+#define NPF_SYST_CVR (*(uint32_t volatile *)0xE000E018u)
+#define NPF_CPACR    (*(uint32_t volatile *)0xE000ED88u)
+
+extern uint32_t __stack_top;
+extern uint32_t __data_load, __data_start, __data_end, __bss_start, __bss_end;
+
+int main(void);
+
+static int semihost(int op, void const *arg) {
+  register int r0 __asm__("r0") = op;
+  register void const *r1 __asm__("r1") = arg;
+  __asm__ volatile("bkpt 0xab" : "+r"(r0) : "r"(r1) : "memory");
+  return r0;
+}
+
+static void put_s(char const *s) { semihost(0x04, s); } // SYS_WRITE0
+
+static void npf_reset(void) {
+  uint32_t *dst = &__data_start;
+  for (uint32_t const *src = &__data_load; dst < &__data_end;) { *dst++ = *src++; }
+  for (dst = &__bss_start; dst < &__bss_end;) { *dst++ = 0; }
+#if defined(__ARM_FP)
+  NPF_CPACR |= 0xFu << 20; // cp10 + cp11, before anything touches the FPU
+  __asm__ volatile("dsb\n isb" ::: "memory");
+#endif
+  main();
+  static uint32_t const exit_block[2] = { 0x20026u, 0 }; // ADP_Stopped_ApplicationExit
+  for (;;) { semihost(0x18, exit_block); } // SYS_EXIT
+}
+
+__attribute__((section(".vectors"), used))
+static void (*const npf_vectors[])(void) = {
+  (void (*)(void))(uintptr_t)&__stack_top,
+  npf_reset,
+};
+
+// Free-running 24-bit down-counter at the core clock. A call can straddle the
+// reload, so deltas are taken modulo 2^24.
+static uint32_t ticks(void) { return NPF_SYST_CVR; }
+static unsigned elapsed(uint32_t t0, uint32_t t1) { return (unsigned)((t0 - t1) & 0x00FFFFFFu); }
+
+static void null_putc(int c, void *ctx) { (void)c; (void)ctx; }
+
+// Exactly 2n instructions: the only thing here whose count is known by construction.
+static __attribute__((noinline)) void spin(uint32_t n) {
+  __asm__ volatile("1: subs %0, #1\n bne 1b" : "+l"(n) :: "cc");
+}
+
+static char line[96];
+
+static void report_spin(uint32_t n) {
+  uint32_t const t0 = ticks();
+  spin(n);
+  uint32_t const t1 = ticks();
+  npf_snprintf(line, sizeof line, "CAL %u %u\n", (unsigned)n, elapsed(t0, t1));
+  put_s(line);
+}
+
+// Starts SysTick and prints the two calibration lines the scripts expect.
+static void npf_cortex_m_start(void) {
+  NPF_SYST_RVR = 0x00FFFFFFu;
+  NPF_SYST_CVR = 0;
+  NPF_SYST_CSR = 0x5u; // enable, core clock, no interrupt
+  report_spin(10000);
+  report_spin(20000);
+}
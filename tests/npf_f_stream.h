@@ -0,0 +1,11 @@
+#pragma once
+
+/* NANOPRINTF_USE_FLOAT_STREAMING hands a %f that outgrew the conversion buffer to
+   npf_ftoa_stream, which repeats npf_ftoa_rev's arithmetic but sends the digits to
+   the sink as they come. So a default-sized buffer with streaming must print
+   exactly what a buffer big enough to never need it prints. Each configuration is
+   its own TU exposing a wrapper, and unit_f_stream.cc compares them. */
+
+int npf_f_streamed_fused(char *buf, unsigned len, char const *fmt, double v);
+int npf_f_streamed_unified(char *buf, unsigned len, char const *fmt, double v);
+int npf_f_big_buffer(char *buf, unsigned len, char const *fmt, double v);
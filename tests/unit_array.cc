@@ -0,0 +1,87 @@
+#define NANOPRINTF_USE_ARRAY_FORMAT_SPECIFIERS 1
+#include "unit_nanoprintf.h"
+
+#include <cstdint>
+#include <cstdio>
+#include <string>
+
+/* 'v' applies one conversion to every element of an array: an int count, a pointer
+   to the elements and a separator string follow any star args. Each element must
+   print what the same conversion prints for it as a vararg. */
+
+TEST_CASE("array modifier") {
+  char a[512];
+
+  SUBCASE("element types follow the length modifier, unpromoted") {
+    signed char const c[] = {-128, 0, 127};
+    short const h[] = {-32768, -1, 32767};
+    unsigned short const uh[] = {0, 0xBEEF, 0xFFFF};
+    int const i[] = {-5, 0, 2147483647};
+    long const l[] = {-1234567890L, 42L};
+    npf_snprintf_ext(a, sizeof a, "[%vhhd][%vhd][%vhx][%vd][%vli]", 3, c, ",", 3, h, ",",
+                     3, uh, ",", 3, i, ",", 2, l, ",");
+    REQUIRE(std::string{a} ==
+            "[-128,0,127][-32768,-1,32767][0,beef,ffff][-5,0,2147483647][-1234567890,42]");
+  }
+
+#if NANOPRINTF_USE_LARGE_FORMAT_SPECIFIERS == 1
+  SUBCASE("large element types") {
+    long long const ll[] = {-9223372036854775807LL - 1, 9223372036854775807LL};
+    size_t const z[] = {0, (size_t)-1};
+    npf_snprintf_ext(a, sizeof a, "%vlld|%vzx", 2, ll, " ", 2, z, " ");
+    char b[128];
+    snprintf(b, sizeof b, "%lld %lld|%zx %zx", ll[0], ll[1], z[0], z[1]);
+    REQUIRE(std::string{a} == b);
+  }
+#endif
+
+  SUBCASE("width, precision and flags apply to every element") {
+    int const v[] = {1, -22, 333};
+    npf_snprintf_ext(a, sizeof a, "%+06vd|%-5vd|%.4vx|%*.*vd", 3, v, " ", 3, v, ":", 3, v, ",",
+                     4, 2, 3, v, "/");
+    REQUIRE(std::string{a} == "+00001 -00022 +00333|1    :-22  :333  |0001,ffffffea,014d|"
+                              "  01/ -22/ 333");
+  }
+
+  SUBCASE("strings, chars and pointers") {
+    char const *const s[] = {"ab", "", "cde"};
+    char const ch[] = {'x', 'y', 'z'};
+    void *const p[] = {nullptr, (void *)0x10};
+    npf_snprintf_ext(a, sizeof a, "[%.2vs][%vc][%vp]", 3, s, "|", 3, ch, "", 2, p, ",");
+    char b[128];
+    npf_snprintf(b, sizeof b, "[ab||cd][xyz][%p,%p]", p[0], p[1]);
+    REQUIRE(std::string{a} == b);
+  }
+
+#if NANOPRINTF_USE_FLOAT_FORMAT_SPECIFIERS == 1
+  SUBCASE("double, float ('h') and long double ('L') arrays" NPF_FLOAT_PATH) {
+    double const d[] = {1.5, -0.25, 100.0};
+    float const f[] = {0.5f, 3.0f};
+    long double const ld[] = {2.0L, -8.5L};
+    npf_snprintf_ext(a, sizeof a, "%.2vf|%.1vhf|%.1vLf", 3, d, ", ", 2, f, ", ", 2, ld, ", ");
+    REQUIRE(std::string{a} == "1.50, -0.25, 100.00|0.5, 3.0|2.0, -8.5");
+  }
+#endif
+
+  SUBCASE("empty arrays, NULL and a NULL separator") {
+    int const v[] = {7, 8};
+    int const r = npf_snprintf_ext(a, sizeof a, "[%vd][%vd][%vd][%vd]", 0, v, ",", -3, v, ",",
+                                   2, nullptr, ",", 2, v, nullptr);
+    REQUIRE(std::string{a} == "[][][][78]");
+    REQUIRE(r == 10);
+  }
+
+  SUBCASE("the return value and %n count separators") {
+    int const v[] = {10, 20, 30};
+    int n = 0;
+    int const r = npf_snprintf_ext(a, sizeof a, "%vd%n!", 3, v, " - ", &n);
+    REQUIRE(std::string{a} == "10 - 20 - 30!");
+    REQUIRE(n == 12);
+    REQUIRE(r == 13);
+  }
+
+  SUBCASE("conversions that aren't one value don't parse") {
+    npf_snprintf_ext(a, sizeof a, "%v%|%vn", 1);
+    REQUIRE(std::string{a} == "%v%|%vn");
+  }
+}
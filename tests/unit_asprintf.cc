@@ -0,0 +1,73 @@
+#define NANOPRINTF_USE_ASPRINTF 1
+#include "unit_nanoprintf.h"
+
+#include <cstdlib>
+#include <string>
+
+/* One allocation of exactly the formatted length plus its NUL, and none at all when
+   the caller's buffer is big enough. */
+
+namespace {
+
+struct Pool {
+  int calls = 0;
+  size_t last = 0;
+  bool fail = false;
+  static void *alloc(void *ctx, size_t size) {
+    Pool *const p = static_cast<Pool *>(ctx);
+    ++p->calls;
+    p->last = size;
+    return p->fail ? nullptr : malloc(size);
+  }
+};
+
+} // namespace
+
+TEST_CASE("allocating printf") {
+  SUBCASE("sizes exactly and allocates once") {
+    Pool pool;
+    char *const s = npf_asprintf(Pool::alloc, &pool, "%s-%05d-%x", "id", 42, 0xbeefu);
+    REQUIRE(s != nullptr);
+    REQUIRE(std::string{s} == "id-00042-beef");
+    REQUIRE(pool.calls == 1);
+    REQUIRE(pool.last == 14);
+    free(s);
+  }
+
+  SUBCASE("the empty string still gets its NUL") {
+    Pool pool;
+    char *const s = npf_asprintf(Pool::alloc, &pool, "%s", "");
+    REQUIRE(std::string{s} == "");
+    REQUIRE(pool.last == 1);
+    free(s);
+  }
+
+  SUBCASE("a buffer that fits means no allocation") {
+    Pool pool;
+    char buf[16];
+    char *const s = npf_asprintf_buf(buf, sizeof buf, Pool::alloc, &pool, "%u apples", 12u);
+    REQUIRE(s == buf);
+    REQUIRE(std::string{s} == "12 apples");
+    REQUIRE(pool.calls == 0);
+  }
+
+  SUBCASE("a buffer one byte short overflows to the allocator") {
+    Pool pool;
+    char buf[9];
+    char *const s = npf_asprintf_buf(buf, sizeof buf, Pool::alloc, &pool, "%u apples", 12u);
+    REQUIRE(s != buf);
+    REQUIRE(std::string{s} == "12 apples");
+    REQUIRE(pool.calls == 1);
+    REQUIRE(pool.last == 10);
+    free(s);
+  }
+
+  SUBCASE("allocator failure is NULL") {
+    Pool pool;
+    pool.fail = true;
+    char buf[4];
+    REQUIRE(npf_asprintf(Pool::alloc, &pool, "%d", 123456) == nullptr);
+    REQUIRE(npf_asprintf_buf(buf, sizeof buf, Pool::alloc, &pool, "%d", 123456) == nullptr);
+    REQUIRE(pool.calls == 2);
+  }
+}
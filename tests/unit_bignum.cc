@@ -0,0 +1,125 @@
+#define NANOPRINTF_USE_BIGNUM_FORMAT_SPECIFIERS 1
+#include "unit_nanoprintf.h"
+
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+/* 'W32' and 'W64' take a count and a pointer to that many limbs, least significant
+   first. Digits must match a plain one-digit-at-a-time long division. */
+
+namespace {
+
+std::string ref(std::vector<uint32_t> w, unsigned base, bool upper = false) {
+  char const *const digits = upper ? "0123456789ABCDEF" : "0123456789abcdef";
+  std::string s;
+  for (;;) {
+    uint64_t r = 0;
+    bool nonzero = false;
+    for (size_t i = w.size(); i-- > 0;) {
+      uint64_t const cur = (r << 32) | w[i];
+      w[i] = (uint32_t)(cur / base);
+      r = cur % base;
+      nonzero = nonzero || w[i];
+    }
+    s.insert(s.begin(), digits[r]);
+    if (!nonzero) { return s; }
+  }
+}
+
+std::vector<uint32_t> pattern(size_t n, uint32_t seed) {
+  std::vector<uint32_t> w(n);
+  for (uint32_t &x : w) { seed = seed * 1664525u + 1013904223u; x = seed; }
+  return w;
+}
+
+} // namespace
+
+TEST_CASE("limb array conversions") {
+  char a[1200];
+
+  SUBCASE("%W32u, %W32o, %W32x, %W32X and %W32b") {
+    for (size_t n = 0; n <= 32; ++n) {
+      for (uint32_t seed : {1u, 77u, 0xFFFFFFFFu}) {
+        std::vector<uint32_t> const w = pattern(n, seed);
+        npf_snprintf_ext(a, sizeof a, "%W32u|%W32o|%W32x|%W32X", (int)n, w.data(), (int)n,
+                         w.data(), (int)n, w.data(), (int)n, w.data());
+        INFO("n=", n, " seed=", seed);
+        REQUIRE(std::string{a} == ref(w, 10) + "|" + ref(w, 8) + "|" + ref(w, 16) + "|" +
+                                  ref(w, 16, true));
+        npf_snprintf_ext(a, sizeof a, "%W32b", (int)n, w.data());
+        REQUIRE(std::string{a} == ref(w, 2));
+      }
+    }
+  }
+
+  SUBCASE("every decimal chunk boundary") {
+    std::vector<uint32_t> w(1, 1);
+    for (int i = 0; i < 300; ++i) { // w = 10^i
+      for (int delta : {-1, 0, 1}) {
+        std::vector<uint32_t> v = w;
+        v[0] += (uint32_t)delta; // no borrow or carry: 10^i is even past i = 0
+        if (!i && (delta < 0)) { continue; }
+        npf_snprintf_ext(a, sizeof a, "%W32u", (int)v.size(), v.data());
+        REQUIRE(std::string{a} == ref(v, 10));
+      }
+      uint64_t c = 0;
+      for (uint32_t &x : w) { c += (uint64_t)x * 10u; x = (uint32_t)c; c >>= 32; }
+      if (c) { w.push_back((uint32_t)c); }
+    }
+  }
+
+  SUBCASE("64-bit limbs and high zero limbs") {
+    uint64_t const l64[] = {0xFEDCBA9876543210ull, 0x0123456789ABCDEFull, 0, 0};
+    uint32_t const l32[] = {0x76543210u, 0xFEDCBA98u, 0x89ABCDEFu, 0x01234567u};
+    npf_snprintf_ext(a, sizeof a, "%W64x %W32x %W64u", 4, l64, 4, l32, 4, l64);
+    REQUIRE(std::string{a} == "123456789abcdeffedcba9876543210 "
+                              "123456789abcdeffedcba9876543210 "
+                              "1512366075204170947332355369683137040");
+  }
+
+  SUBCASE("zero") {
+    uint32_t const z[] = {0, 0};
+    npf_snprintf_ext(a, sizeof a, "[%W32u][%W32x][%#W32o][%.0W32u][%#.0W32o][%3W64d]", 2, z,
+                     0, nullptr, 2, z, 2, z, 2, z, 1, z);
+    REQUIRE(std::string{a} == "[0][0][0][][0][  0]");
+  }
+
+  SUBCASE("flags, width and precision") {
+    uint32_t const v[] = {0, 0, 0, 0x10}; // 2^100
+    npf_snprintf_ext(a, sizeof a, "%+45W32d|%-33W32x|%#W32x|%#W32o|%.40W32u|%040W32i", 4, v,
+                     4, v, 4, v, 4, v, 4, v, 4, v);
+    REQUIRE(std::string{a} ==
+            "             +1267650600228229401496703205376|"
+            "10000000000000000000000000       |"
+            "0x10000000000000000000000000|"
+            "02000000000000000000000000000000000|"
+            "0000000001267650600228229401496703205376|"
+            "0000000001267650600228229401496703205376");
+    npf_snprintf_ext(a, sizeof a, "% W32d|%#W32X|%#W32b", 4, v, 4, v, 1, v + 3);
+    REQUIRE(std::string{a} == " 1267650600228229401496703205376|"
+                              "0X10000000000000000000000000|0b10000");
+  }
+
+  SUBCASE("the whole array counts, not only the conversion buffer") {
+    std::vector<uint32_t> const w = pattern(32, 5);
+    int const n = npf_snprintf_ext(nullptr, 0, "%W32b", 32, w.data());
+    REQUIRE(n == (int)ref(w, 2).size());
+  }
+
+  SUBCASE("wider than NANOPRINTF_BIGNUM_MAX_BITS is an error") {
+    std::vector<uint32_t> w = pattern(33, 9);
+    npf_snprintf_ext(a, sizeof a, "%05W32u|%#W32x", 33, w.data(), 33, w.data());
+    REQUIRE(std::string{a} == "  err|err");
+    w[32] = 0; // high zero limbs don't count against the limit
+    npf_snprintf_ext(a, sizeof a, "%W32x", 33, w.data());
+    REQUIRE(std::string{a} == ref(w, 16));
+  }
+
+  SUBCASE("other spellings and conversions don't parse") {
+    uint32_t const v[] = {1};
+    npf_snprintf_ext(a, sizeof a, "%W32s|%W32c|%W16u|%Wd", 1, v, 1, v, 1, v, 1, v);
+    REQUIRE(std::string{a} == "%W32s|%W32c|%W16u|%Wd");
+  }
+}
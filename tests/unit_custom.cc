@@ -0,0 +1,130 @@
+#define NANOPRINTF_USE_CUSTOM_FORMAT_SPECIFIERS 1
+#include "unit_nanoprintf.h"
+
+#include <cstdint>
+#include <string>
+
+/* A registered letter's handler writes straight to the sink; nanoprintf supplies
+   the argument and the field width around it. */
+
+namespace {
+
+int put_str(npf_putc pc, void *ctx, char const *s) {
+  int n = 0;
+  for (; s[n]; ++n) { if (pc) { pc(s[n], ctx); } }
+  return n;
+}
+
+// %m: a 6-byte MAC address, '#' for '-' separators, 'M' for uppercase.
+int mac(npf_putc pc, void *ctx, npf_custom_spec_t const *spec) {
+  unsigned char const *const b = (unsigned char const *)spec->arg.p;
+  char const *const digits = (spec->conv == 'M') ? "0123456789ABCDEF" : "0123456789abcdef";
+  int n = 0;
+  for (int i = 0; i < 6; ++i) {
+    char const out[3] = {(char)(i ? (spec->alt_form ? '-' : ':') : 0), digits[b[i] >> 4],
+                         digits[b[i] & 15]};
+    for (char c : out) {
+      if (!c) { continue; }
+      if (pc) { pc(c, ctx); }
+      ++n;
+    }
+  }
+  return n;
+}
+
+// %q: an IPv4 address in host order, passed as a long.
+int ipv4(npf_putc pc, void *ctx, npf_custom_spec_t const *spec) {
+  unsigned long const a = (unsigned long)spec->arg.i;
+  char buf[16];
+  npf_snprintf(buf, sizeof buf, "%lu.%lu.%lu.%lu", (a >> 24) & 255, (a >> 16) & 255,
+               (a >> 8) & 255, a & 255);
+  return put_str(pc, ctx, buf);
+}
+
+// %y is past 'x', so an enum goes on %r here: the precision truncates the name.
+int color(npf_putc pc, void *ctx, npf_custom_spec_t const *spec) {
+  static char const *const names[] = {"red", "green", "blue"};
+  char const *const s = ((spec->arg.i >= 0) && (spec->arg.i < 3)) ? names[spec->arg.i] : "?";
+  int n = 0;
+  for (; s[n] && ((spec->prec < 0) || (n < spec->prec)); ++n) {
+    if (pc) { pc(s[n], ctx); }
+  }
+  return n;
+}
+
+struct Registered {
+  Registered() {
+    npf_custom_register('m', NPF_CUSTOM_ARG_PTR, mac);
+    npf_custom_register('q', NPF_CUSTOM_ARG_LONG, ipv4);
+    npf_custom_register('r', NPF_CUSTOM_ARG_INT, color);
+  }
+};
+
+} // namespace
+
+TEST_CASE("user conversions") {
+  static Registered const registered;
+  char a[128];
+  unsigned char const m[6] = {0x00, 0x1A, 0x2B, 0x3C, 0x4D, 0xFE};
+
+  SUBCASE("handlers write their argument") {
+    int const r = npf_snprintf_ext(a, sizeof a, "%m %M %#m|%q|%r,%r,%r", m, m, m, 0xC0A80001L,
+                                   0, 2, 7);
+    REQUIRE(std::string{a} == "00:1a:2b:3c:4d:fe 00:1A:2B:3C:4D:FE 00-1a-2b-3c-4d-fe|"
+                              "192.168.0.1|red,blue,?");
+    REQUIRE(r == (int)std::string{a}.size());
+  }
+
+  SUBCASE("nanoprintf applies the field width") {
+    int const r = npf_snprintf_ext(a, sizeof a, "[%18q][%-18q][%*r][%-*r]", 0x0A000001L,
+                                   0x0A000001L, 7, 1, -7, 1);
+    REQUIRE(std::string{a} ==
+            "[          10.0.0.1][10.0.0.1          ][  green][green  ]");
+    REQUIRE(r == (int)std::string{a}.size());
+  }
+
+  SUBCASE("the precision is the handler's") {
+    npf_snprintf_ext(a, sizeof a, "[%.2r][%6.3r][%.0r]", 1, 2, 0);
+    REQUIRE(std::string{a} == "[gr][   blu][]");
+  }
+
+  SUBCASE("%n counts handler output") {
+    int n = 0;
+    npf_snprintf_ext(a, sizeof a, "%q%n", 0x7F000001L, &n);
+    REQUIRE(n == 9);
+  }
+
+  SUBCASE("built-in letters and length modifiers can't be registered") {
+    REQUIRE(!npf_custom_register('d', NPF_CUSTOM_ARG_INT, color));
+    REQUIRE(!npf_custom_register('X', NPF_CUSTOM_ARG_INT, color));
+    REQUIRE(!npf_custom_register('l', NPF_CUSTOM_ARG_INT, color));
+    REQUIRE(!npf_custom_register('z', NPF_CUSTOM_ARG_INT, color));
+    REQUIRE(!npf_custom_register('k', 3, color));
+    npf_snprintf(a, sizeof a, "%d", 5);
+    REQUIRE(std::string{a} == "5");
+  }
+
+  SUBCASE("a modifier letter is free when this build doesn't have the modifier") {
+    char b[64];
+    npf_snprintf_ext(b, sizeof b, "%r", 2);
+#if NANOPRINTF_USE_LARGE_FORMAT_SPECIFIERS == 1
+    REQUIRE(!npf_custom_register('j', NPF_CUSTOM_ARG_INT, color));
+    REQUIRE(!npf_custom_register('T', NPF_CUSTOM_ARG_INT, color));
+#else
+    REQUIRE(npf_custom_register('j', NPF_CUSTOM_ARG_INT, color));
+    npf_snprintf_ext(a, sizeof a, "%j", 2);
+    REQUIRE(std::string{a} == b);
+    REQUIRE(npf_custom_register('j', NPF_CUSTOM_ARG_INT, nullptr));
+#endif
+    REQUIRE(!npf_custom_register('w', NPF_CUSTOM_ARG_INT, color)); // fixed-width
+    REQUIRE(npf_custom_register('v', NPF_CUSTOM_ARG_INT, color));  // no array modifier
+    REQUIRE(npf_custom_register('v', NPF_CUSTOM_ARG_INT, nullptr));
+  }
+
+  SUBCASE("unregistered letters and length modifiers don't parse") {
+    REQUIRE(npf_custom_register('k', NPF_CUSTOM_ARG_INT, color));
+    REQUIRE(npf_custom_register('k', NPF_CUSTOM_ARG_INT, nullptr));
+    npf_snprintf_ext(a, sizeof a, "%k|%lq|%hr", 1, 2L, 3);
+    REQUIRE(std::string{a} == "%k|%lq|%hr");
+  }
+}
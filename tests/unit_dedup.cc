@@ -0,0 +1,60 @@
+#define NANOPRINTF_USE_DEDUP_SINK 1
+#include "unit_nanoprintf.h"
+
+#include <string>
+
+/* Repeats of a record must be counted, not printed, and the count must come out
+   before the next different record, at the window, or on a flush. */
+
+TEST_CASE("dedup sink") {
+  std::string out;
+  npf_dedup_t dd;
+  npf_dedup_init(&dd, append, &out, 0);
+
+  SUBCASE("repeats are counted until the record changes") {
+    for (int i = 0; i < 4; ++i) {
+      REQUIRE(npf_dedup_pprintf(&dd, "err %d on %s\n", -5, "spi1") == ((i == 0) ? 15 : 0));
+    }
+    npf_dedup_pprintf(&dd, "err %d on %s\n", -5, "spi2");
+    npf_dedup_pprintf(&dd, "err %d on %s\n", -6, "spi2");
+    REQUIRE(out == "err -5 on spi1\nlast message repeated 3 times\n"
+                   "err -5 on spi2\nerr -6 on spi2\n");
+  }
+
+  SUBCASE("strings are keyed by content, not by pointer") {
+    char a[] = "busy", b[] = "busy";
+    npf_dedup_pprintf(&dd, "%s|%.2s\n", a, "xyz");
+    npf_dedup_pprintf(&dd, "%s|%.2s\n", b, "xyq"); // the same text
+    a[0] = 'B';
+    npf_dedup_pprintf(&dd, "%s|%.2s\n", a, "xy");
+    REQUIRE(out == "busy|xy\nlast message repeated 1 times\nBusy|xy\n");
+  }
+
+  SUBCASE("the same text from another format string is another record") {
+    char const *const f1 = "%u\n";
+    char const f2[] = "%u\n";
+    npf_dedup_pprintf(&dd, f1, 1u);
+    npf_dedup_pprintf(&dd, f2, 1u);
+    REQUIRE(out == "1\n1\n");
+  }
+
+  SUBCASE("the window and flush report pending repeats") {
+    npf_dedup_t w;
+    npf_dedup_init(&w, append, &out, 3);
+    for (int i = 0; i < 6; ++i) { npf_dedup_pprintf(&w, "tick %*d\n", 3, 9); }
+    REQUIRE(out == "tick   9\nlast message repeated 3 times\n");
+    REQUIRE(npf_dedup_flush(&w) == 30);
+    REQUIRE(npf_dedup_flush(&w) == 0);
+    REQUIRE(out == "tick   9\nlast message repeated 3 times\nlast message repeated 2 times\n");
+  }
+
+  SUBCASE("stars, floats and records capture can't take") {
+    npf_dedup_pprintf(&dd, "[%*d %.1f]", 4, 1, 2.5);
+    npf_dedup_pprintf(&dd, "[%*d %.1f]", 5, 1, 2.5);
+    npf_dedup_pprintf(&dd, "[%*d %.1f]", 5, 1, 2.25);
+    int wb = 0;
+    npf_dedup_pprintf(&dd, "%d%n", 1, &wb);
+    npf_dedup_pprintf(&dd, "%d%n", 1, &wb);
+    REQUIRE(out == "[   1 2.5][    1 2.5][    1 2.2]11");
+  }
+}
@@ -0,0 +1,75 @@
+#define NANOPRINTF_USE_DEFERRED_LOG 1
+#include "unit_nanoprintf.h"
+
+#include <cstring>
+#include <string>
+
+/* A dump must print what npf_snprintf would have printed when the records were
+   logged, for whichever records the ring still holds. */
+
+namespace {
+
+std::string dump(npf_ring_t *ring) {
+  std::string out;
+  int const n = npf_ring_dump(ring, append, &out);
+  REQUIRE(n == (int)out.size());
+  return out;
+}
+
+} // namespace
+
+TEST_CASE("deferred log") {
+  unsigned char mem[256];
+  npf_ring_t ring;
+  npf_ring_init(&ring, mem, sizeof mem);
+
+  SUBCASE("records print at dump time as they would have when logged") {
+    char name[8];
+    strcpy(name, "gw-7");
+    REQUIRE(npf_ring_log(&ring, "rx %u from %s rssi=%d%c", 1500u, name, -87, ';') > 0);
+    strcpy(name, "gone"); // the string was copied
+    npf_ring_log(&ring, "[%-*.*s][%*d][%hhd][%lx][%p]", 6, 2, "abcdef", 4, 7,
+                 (signed char)-3, 0xdeadbeeful, (void *)mem);
+    npf_ring_log(&ring, "%.3f %e %s|", -2.5, 6.02e23, (char const *)nullptr);
+    char ref[256];
+    npf_snprintf(ref, sizeof ref, "rx %u from %s rssi=%d%c[%-*.*s][%*d][%hhd][%lx][%p]"
+                 "%.3f %e %s|", 1500u, "gw-7", -87, ';', 6, 2, "abcdef", 4, 7,
+                 (signed char)-3, 0xdeadbeeful, (void *)mem, -2.5, 6.02e23, "");
+    REQUIRE(dump(&ring) == ref);
+    REQUIRE(dump(&ring) == ref); // dumping doesn't consume
+    REQUIRE(ring.lost == 0);
+  }
+
+  SUBCASE("a full ring keeps the newest records") {
+    std::string ref;
+    for (int i = 0; i < 40; ++i) {
+      npf_ring_log(&ring, "<%d:%s>", i * 1000, "abc");
+    }
+    REQUIRE(ring.lost > 0);
+    REQUIRE(ring.used <= sizeof mem);
+    for (int i = (int)ring.lost; i < 40; ++i) {
+      char tmp[32];
+      npf_snprintf(tmp, sizeof tmp, "<%d:%s>", i * 1000, "abc");
+      ref += tmp;
+    }
+    REQUIRE(dump(&ring) == ref);
+    npf_ring_log(&ring, "<%d>", 40); // the rotated ring keeps going
+    REQUIRE(dump(&ring) == ref.substr(ref.find('>') + 1) + "<40>");
+  }
+
+  SUBCASE("a string too long for the ring is cut to fit") {
+    unsigned char small[32];
+    npf_ring_t r;
+    npf_ring_init(&r, small, sizeof small);
+    npf_ring_log(&r, "old");
+    REQUIRE(npf_ring_log(&r, "x=%d s=%s", 5, "a string too long for the ring") == 32);
+    REQUIRE(r.lost == 1); // the record can have the ring to itself
+    REQUIRE(dump(&r) == "x=5 s=a string too long");
+  }
+
+  SUBCASE("a conversion capture can't take ends the record") {
+    int wb = 0;
+    npf_ring_log(&ring, "%d%n%d", 7, &wb, 8);
+    REQUIRE(dump(&ring) == "7");
+  }
+}
@@ -0,0 +1,96 @@
+#define NANOPRINTF_USE_ESCAPED_STRING_FORMAT_SPECIFIERS 1
+#include "unit_nanoprintf.h"
+
+#include <cstdio>
+#include <string>
+
+/* "%#s" must escape exactly what a JSON string body needs and "%+s" must quote
+   exactly the CSV fields that need it, wherever in a word the special byte falls. */
+
+namespace {
+
+std::string esc(char const *fmt, char const *s) {
+  char buf[512];
+  int const n = npf_snprintf_ext(buf, sizeof buf, fmt, s);
+  REQUIRE(n == (int)std::string{buf}.size());
+  return buf;
+}
+
+std::string json_ref(std::string const &s) {
+  std::string r;
+  for (char ch : s) {
+    unsigned char const c = (unsigned char)ch;
+    char u[8];
+    switch (c) {
+      case '"': r += "\\\""; break;
+      case '\\': r += "\\\\"; break;
+      case '\b': r += "\\b"; break;
+      case '\f': r += "\\f"; break;
+      case '\n': r += "\\n"; break;
+      case '\r': r += "\\r"; break;
+      case '\t': r += "\\t"; break;
+      default:
+        if (c < 0x20) { snprintf(u, sizeof u, "\\u%04x", c); r += u; } else { r += (char)c; }
+    }
+  }
+  return r;
+}
+
+std::string csv_ref(std::string const &s) {
+  if (s.find_first_of(",\"\n\r") == std::string::npos) { return s; }
+  std::string r = "\"";
+  for (char c : s) { r += c; if (c == '"') { r += c; } }
+  return r + "\"";
+}
+
+} // namespace
+
+TEST_CASE("escaped string conversions") {
+  SUBCASE("plain text is copied") {
+    REQUIRE(esc("%#s", "hello, world") == "hello, world");
+    REQUIRE(esc("%+s", "hello world, but longer than one word") ==
+            "\"hello world, but longer than one word\"");
+    REQUIRE(esc("%+s", "plain field") == "plain field");
+    REQUIRE(esc("%#s|%+s", "") == "|");
+  }
+
+  SUBCASE("JSON") {
+    REQUIRE(esc("%#s", "say \"hi\"\\\n") == "say \\\"hi\\\"\\\\\\n");
+    REQUIRE(esc("%#s", "\x01\x1f\t\b\f\r\x7f") == "\\u0001\\u001f\\t\\b\\f\\r\x7f");
+    REQUIRE(esc("%#s", "caf\xc3\xa9") == "caf\xc3\xa9"); // UTF-8 passes through
+  }
+
+  SUBCASE("CSV") {
+    REQUIRE(esc("%+s", "a\"b") == "\"a\"\"b\"");
+    REQUIRE(esc("%+s", "two\r\nlines") == "\"two\r\nlines\"");
+    REQUIRE(esc("%+s", "tab\there") == "tab\there");
+  }
+
+  SUBCASE("every special byte at every offset") {
+    std::string const specials = std::string("\"\\,\n\r\t\x01\x1f", 8);
+    for (size_t len = 1; len <= 24; ++len) {
+      for (size_t at = 0; at < len; ++at) {
+        for (char c : specials) {
+          std::string s(len, 'x');
+          s[at] = c;
+          INFO("len=", len, " at=", at, " c=", (int)c);
+          REQUIRE(esc("%#s", s.c_str()) == json_ref(s));
+          REQUIRE(esc("%+s", s.c_str()) == csv_ref(s));
+        }
+      }
+    }
+  }
+
+  SUBCASE("width pads the escaped text, precision cuts the source") {
+    REQUIRE(esc("%#8s|", "a\"b") == "    a\\\"b|");
+    REQUIRE(esc("%-+8s|", "a,b") == "\"a,b\"   |");
+    REQUIRE(esc("%#.2s", "\"\"\"") == "\\\"\\\"");
+    REQUIRE(esc("%+.3s", "ab,cd") == "\"ab,\"");
+  }
+
+  SUBCASE("a NULL string prints nothing") {
+    char buf[16];
+    npf_snprintf_ext(buf, sizeof buf, "[%#s%+s]", (char const *)nullptr, (char const *)nullptr);
+    REQUIRE(std::string{buf} == "[]");
+  }
+}
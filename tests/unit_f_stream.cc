@@ -0,0 +1,116 @@
+#include "unit_nanoprintf.h"
+
+#include "npf_f_stream.h"
+
+#include <cfloat>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <string>
+
+namespace {
+
+bool is_err(char const *s) { return strstr(s, "err") || strstr(s, "ERR"); }
+
+using conv_fn = int (*)(char *, unsigned, char const *, double);
+
+void compare(conv_fn streamed, char const *fmt, double v) {
+  static char a[1200], b[1200];
+  int const ra = streamed(a, sizeof a, fmt, v);
+  int const rb = npf_f_big_buffer(b, sizeof b, fmt, v);
+  INFO("fmt=", fmt, " v=", v);
+  REQUIRE(!is_err(b)); // otherwise the reference buffer is too small for the sweep
+  CHECK(std::string{a} == std::string{b});
+  CHECK(ra == rb);
+}
+
+uint64_t rng_state;
+uint64_t rng() {
+  rng_state ^= rng_state << 13;
+  rng_state ^= rng_state >> 7;
+  rng_state ^= rng_state << 17;
+  return rng_state;
+}
+
+char const *const kPatterns[] = {
+  "%%.%df", "%%#.%df", "%%+.%df", "%%400.%df", "%%-400.%df", "%%0400.%df",
+};
+constexpr size_t kNumPatterns = sizeof kPatterns / sizeof *kPatterns;
+
+double const kVals[] = {
+  0.0, 1.0, 0.5, 2.5, 0.1, 1.0 / 3.0, 9.9999, 999.95, 0.999999, 99.5, 1e15, 1e20,
+  1e-20, 1e22, 1e-5, 5e-324, 1e-300, 1e300, DBL_MAX, DBL_MIN, 123456789012345.678,
+  4294967295.5, 18446744073709551616.0, 9.999999999999999e99,
+};
+
+void sweep(conv_fn streamed) {
+  char fmt[24];
+  for (double v : kVals) {
+    for (int p : {0, 1, 6, 17, 30, 61, 62, 63, 100, 340, 400}) {
+      for (size_t k = 0; k < kNumPatterns; ++k) {
+        snprintf(fmt, sizeof fmt, kPatterns[k], p);
+        compare(streamed, fmt, v);
+        compare(streamed, fmt, -v);
+      }
+    }
+  }
+
+  rng_state = 0x0F1E2D3C4B5A6978ull;
+  for (int i = 0; i < 20000; ++i) { // arbitrary finite bit patterns
+    union { uint64_t u; double d; } x;
+    x.u = rng();
+    if (std::isnan(x.d) || std::isinf(x.d)) { continue; }
+    snprintf(fmt, sizeof fmt, kPatterns[rng() % kNumPatterns], (int)(rng() % 400));
+    compare(streamed, fmt, x.d);
+  }
+}
+
+} // namespace
+
+TEST_CASE("streamed %f matches an unbounded buffer [fused %f]") {
+  sweep(npf_f_streamed_fused);
+}
+
+TEST_CASE("streamed %f matches an unbounded buffer [shared %f]") {
+  sweep(npf_f_streamed_unified);
+}
+
+TEST_CASE("streamed %f") {
+  char buf[1200];
+
+  SUBCASE("large magnitudes print every integer digit") {
+    // 1e300 is 9.99999904e299 through the default 32-bit intermediate.
+    REQUIRE(npf_f_streamed_fused(buf, sizeof buf, "%.0f", 1e300) == 300);
+    REQUIRE(std::string{buf, 10} == "9999999040");
+    REQUIRE(npf_f_streamed_unified(buf, sizeof buf, "%.1f", -1e300) == 303);
+    REQUIRE(std::string{buf + 299} == "00.0");
+  }
+
+  SUBCASE("large precisions print every fraction digit") {
+    REQUIRE(npf_f_streamed_fused(buf, sizeof buf, "%.100f", 0.5) == 102);
+    REQUIRE(std::string{buf, 4} == "0.50");
+    REQUIRE(std::string{buf + 98} == "0000");
+  }
+
+  SUBCASE("a carry out of held nines grows a digit") {
+    REQUIRE(npf_f_streamed_fused(buf, sizeof buf, "%.70f", 9.9999999999999999) == 73);
+    REQUIRE(std::string{buf, 4} == "10.0");
+  }
+
+  SUBCASE("field width pads to the streamed length") {
+    REQUIRE(npf_f_streamed_fused(buf, sizeof buf, "%80.70f", 1.0) == 80);
+    REQUIRE(std::string{buf, 9} == "        1");
+    REQUIRE(npf_f_streamed_fused(buf, sizeof buf, "%-80.70f|", 1.0) == 81);
+    REQUIRE(std::string{buf + 72} == "        |");
+    REQUIRE(npf_f_streamed_fused(buf, sizeof buf, "%+080.70f", 1.0) == 80);
+    REQUIRE(std::string{buf, 10} == "+00000001.");
+  }
+
+  SUBCASE("specials still print as text") {
+    REQUIRE(npf_f_streamed_fused(buf, sizeof buf, "%.100f", (double)INFINITY) == 3);
+    REQUIRE(std::string{buf} == "inf");
+    REQUIRE(npf_f_streamed_unified(buf, sizeof buf, "%.100f", (double)NAN) == 3);
+    REQUIRE(std::string{buf} == "nan");
+  }
+}
@@ -0,0 +1,12 @@
+// The reference: the fused %f path with a buffer no test value outgrows.
+#define NANOPRINTF_CONVERSION_BUFFER_SIZE 1024
+#define NANOPRINTF_USE_FLOAT_SCI_FORMAT_SPECIFIER 0
+#define NANOPRINTF_USE_FLOAT_SHORTEST_FORMAT_SPECIFIER 0
+
+#include "unit_nanoprintf.h"
+
+#include "npf_f_stream.h"
+
+int npf_f_big_buffer(char *buf, unsigned len, char const *fmt, double v) {
+  return npf_snprintf(buf, (size_t)len, fmt, v);
+}
@@ -0,0 +1,12 @@
+// Streaming with the unified %f path: sci conversions on, default conversion buffer.
+#define NANOPRINTF_USE_FLOAT_STREAMING 1
+#define NANOPRINTF_USE_FLOAT_SCI_FORMAT_SPECIFIER 1
+#define NANOPRINTF_USE_FLOAT_SHORTEST_FORMAT_SPECIFIER 1
+
+#include "unit_nanoprintf.h"
+
+#include "npf_f_stream.h"
+
+int npf_f_streamed_unified(char *buf, unsigned len, char const *fmt, double v) {
+  return npf_snprintf(buf, (size_t)len, fmt, v);
+}
@@ -0,0 +1,124 @@
+#define NANOPRINTF_USE_FIXED_POINT_FORMAT_SPECIFIERS 1
+#include "unit_nanoprintf.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+
+/* %k is m / 2^scale and %r is m / 10^scale. Both must print what %f prints for the
+   exact value, rounding included, without going through a float. */
+
+namespace {
+
+std::string k(char const *fmt, int scale, long m) {
+  char buf[128];
+  npf_snprintf_ext(buf, sizeof buf, fmt, scale, m);
+  return buf;
+}
+
+// m / 10^scale, correctly rounded to prec places, by decimal string arithmetic.
+std::string scaled_ref(long long m, int scale, int prec) {
+  std::string d = std::to_string(m < 0 ? -(unsigned long long)m : (unsigned long long)m);
+  d.insert(0, (size_t)std::max(0, scale + 1 - (int)d.size()), '0');
+  if (prec < scale) {
+    std::string const drop = d.substr(d.size() - (size_t)(scale - prec));
+    d.resize(d.size() - drop.size());
+    bool const up = (drop[0] > '5') ||
+      ((drop[0] == '5') &&
+       ((drop.find_first_not_of('0', 1) != std::string::npos) || ((d.back() - '0') & 1)));
+    for (size_t i = d.size(); up && i-- > 0;) {
+      if (d[i] != '9') { ++d[i]; break; }
+      d[i] = '0';
+      if (!i) { d.insert(0, 1, '1'); }
+    }
+  } else {
+    d.append((size_t)(prec - scale), '0');
+  }
+  if (prec) { d.insert(d.size() - (size_t)prec, 1, '.'); }
+  return ((m < 0) ? "-" : "") + d;
+}
+
+} // namespace
+
+TEST_CASE("fixed-point conversions") {
+  char a[128], b[128];
+
+  SUBCASE("%k matches %f of the exact value") {
+    long long const ms[] = {0, 1, -1, 3, 12345, -12345, 0x7FFF, -0x8000, 0x40000000,
+                            0x7FFFFFFF, -0x7FFFFFFFLL - 1, 0xFFFFFFFFLL, 1LL << 40,
+                            (1LL << 52) - 1, -((1LL << 52) + 7)};
+    for (long long m : ms) {
+      for (int q = 0; q <= 52; ++q) {
+        for (int prec : {0, 1, 3, 6, 15, 20}) {
+          npf_snprintf_ext(a, sizeof a, "%.*lk", prec, q, (long)m);
+          snprintf(b, sizeof b, "%.*f", prec, std::ldexp((double)m, -q));
+          INFO("m=", m, " q=", q, " prec=", prec);
+          REQUIRE(std::string{a} == std::string{b});
+        }
+      }
+    }
+  }
+
+  SUBCASE("%r matches exact decimal rounding") {
+    long long const ms[] = {0, 5, -5, 15, 25, 995, 1005, 123456789, -987654321,
+                            999999999, 0x7FFFFFFF, 1000000000000LL};
+    for (long long m : ms) {
+      for (int s = 0; s <= 14; ++s) {
+        for (int prec : {0, 1, 2, 5, 9, 16}) {
+          npf_snprintf_ext(a, sizeof a, "%.*lr", prec, s, (long)m);
+          INFO("m=", m, " s=", s, " prec=", prec);
+          REQUIRE(std::string{a} == scaled_ref(m, s, prec));
+        }
+      }
+    }
+  }
+
+  SUBCASE("default precision") {
+    REQUIRE(k("%lk", 15, 0x4000) == "0.500000");        // like %f
+    REQUIRE(k("%lr", 3, -12345) == "-12.345");         // exactly the scale
+    REQUIRE(k("%lr", 0, 42) == "42");
+  }
+
+  SUBCASE("Q15 and Q31 through their own length modifiers") {
+    npf_snprintf_ext(a, sizeof a, "%.5hk %.5hk", 15, (short)-0x8000, 15, (short)0x7FFF);
+    REQUIRE(std::string{a} == "-1.00000 0.99997");
+    npf_snprintf_ext(a, sizeof a, "%.10k", 31, (int)0x80000000);
+    REQUIRE(std::string{a} == "-1.0000000000");
+    npf_snprintf_ext(a, sizeof a, "%.9K", 32, 0xFFFFFFFFu);
+    REQUIRE(std::string{a} == "1.000000000");
+  }
+
+  SUBCASE("uppercase is unsigned") {
+    npf_snprintf_ext(a, sizeof a, "%.1K %R", 1, 0xFFFFFFFFu, 2, 0xFFFFFFFFu);
+    REQUIRE(std::string{a} == "2147483647.5 42949672.95");
+  }
+
+  SUBCASE("ties go to even") {
+    npf_snprintf_ext(a, sizeof a, "%.0k %.0k %.0k %.1r %.1r", 1, 1, 1, 3, 1, 5, 2, 25, 2, 35);
+    REQUIRE(std::string{a} == "0 2 2 0.2 0.4");
+  }
+
+  SUBCASE("carry reaches a new integer digit") {
+    REQUIRE(k("%.2lk", 10, 1023) == "1.00");
+    REQUIRE(k("%.1lr", 3, 99960) == "100.0");
+    REQUIRE(k("%.0lr", 1, -95) == "-10");
+  }
+
+  SUBCASE("flags and field width") {
+    REQUIRE(k("%+.2lk", 8, 384) == "+1.50");
+    REQUIRE(k("% .2lk", 8, 384) == " 1.50");
+    REQUIRE(k("%8.2lk", 8, -384) == "   -1.50");
+    REQUIRE(k("%-8.2lk|", 8, 384) == "1.50    |");
+    REQUIRE(k("%08.2lk", 8, -384) == "-0001.50");
+    REQUIRE(k("%#.0lr", 2, 1234) == "12.");
+  }
+
+  SUBCASE("a scale out of range or a payload past the buffer is an error") {
+    REQUIRE(k("%05lk", -1, 1) == "  err");
+    REQUIRE(k("%lK", 65, 1) == "ERR");
+    REQUIRE(k("%lr", -1, 1) == "err");
+    REQUIRE(k("%.70lr", 0, 1) == "err");
+  }
+}
@@ -0,0 +1,94 @@
+#define NANOPRINTF_USE_FLOAT_BITS_FORMAT_SPECIFIERS 1
+#include "unit_nanoprintf.h"
+
+#include <cfloat>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <string>
+
+/* 'U32' and 'U64' take the argument as IEEE-754 bits, and must print exactly what
+   the plain conversion prints for the value those bits spell. */
+
+namespace {
+
+uint32_t bits_of(float f) {
+  uint32_t u;
+  memcpy(&u, &f, sizeof(u));
+  return u;
+}
+
+uint64_t bits_of(double d) {
+  uint64_t u;
+  memcpy(&u, &d, sizeof(u));
+  return u;
+}
+
+float const kFloats[] = {
+  0.0f, -0.0f, 1.0f, -1.5f, 0.1f, 3.14159265f, 1e-5f, 123456.789f, 1e30f, FLT_MAX,
+  FLT_MIN, FLT_TRUE_MIN, FLT_MIN / 3.0f, FLT_EPSILON, (float)INFINITY,
+  -(float)INFINITY, (float)NAN,
+};
+
+// Flags, width and precision come before the length modifier, the letter after it.
+struct Conv { char const *opts; char letter; };
+Conv const kConvs[] = {
+  {"", 'f'}, {".3", 'f'}, {"+12.1", 'f'}, {"", 'e'}, {".8", 'E'}, {"", 'g'}, {"#.3", 'g'},
+  {"", 'a'}, {".2", 'A'},
+};
+
+} // namespace
+
+TEST_CASE("float bits length modifiers" NPF_FLOAT_PATH) {
+  char a[128], b[128], fmt_bits[24], fmt_val[24];
+
+  SUBCASE("U32 prints what the float prints") {
+    for (Conv const &c : kConvs) {
+      snprintf(fmt_bits, sizeof fmt_bits, "%%%sU32%c", c.opts, c.letter);
+      snprintf(fmt_val, sizeof fmt_val, "%%%s%c", c.opts, c.letter);
+      for (float f : kFloats) {
+        int const ra = npf_snprintf_ext(a, sizeof a, fmt_bits, bits_of(f));
+        int const rb = npf_snprintf(b, sizeof b, fmt_val, (double)f);
+        INFO("fmt=", fmt_bits, " v=", (double)f);
+        CHECK(std::string{a} == std::string{b});
+        CHECK(ra == rb);
+      }
+    }
+  }
+
+  SUBCASE("U64 prints what the double prints") {
+    double const vals[] = {0.0, -2.5, 0.1, 1e300, DBL_MAX, DBL_MIN, DBL_TRUE_MIN,
+                           (double)INFINITY, (double)NAN};
+    for (Conv const &c : kConvs) {
+      snprintf(fmt_bits, sizeof fmt_bits, "%%%sU64%c", c.opts, c.letter);
+      snprintf(fmt_val, sizeof fmt_val, "%%%s%c", c.opts, c.letter);
+      for (double d : vals) {
+        int const ra = npf_snprintf_ext(a, sizeof a, fmt_bits, bits_of(d));
+        int const rb = npf_snprintf(b, sizeof b, fmt_val, d);
+        INFO("fmt=", fmt_bits, " v=", d);
+        CHECK(std::string{a} == std::string{b});
+        CHECK(ra == rb);
+      }
+    }
+  }
+
+  SUBCASE("every float exponent widens exactly") {
+    for (uint32_t e = 0; e < 256; ++e) {
+      for (uint32_t man : {0u, 1u, 0x400000u, 0x7FFFFFu}) {
+        uint32_t const u = (e << 23) | man;
+        float f;
+        memcpy(&f, &u, sizeof(f));
+        // A NaN's payload survives, but the cast may also set its quiet bit.
+        REQUIRE((std::isnan(f) || (npf_bits32_to_bits64(u) == bits_of((double)f))));
+        npf_snprintf_ext(a, sizeof a, "%U32a", u);
+        npf_snprintf(b, sizeof b, "%a", (double)f);
+        REQUIRE(std::string{a} == std::string{b});
+      }
+    }
+  }
+
+  SUBCASE("other widths and conversions don't parse") {
+    npf_snprintf_ext(a, sizeof a, "%U16f|%U32d|%U64x|%U", 1u, 2u, (uint64_t)3);
+    REQUIRE(std::string{a} == "%U16f|%U32d|%U64x|%U");
+  }
+}
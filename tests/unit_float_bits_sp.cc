@@ -0,0 +1,56 @@
+#define NANOPRINTF_USE_FLOAT_SINGLE_PRECISION 1
+#define NANOPRINTF_USE_FLOAT_BITS_FORMAT_SPECIFIERS 1
+#define NANOPRINTF_USE_FLOAT_HALF_FORMAT_SPECIFIERS 1
+#include "unit_nanoprintf.h"
+
+#include <cfloat>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <string>
+
+// In single-precision mode 'U32' is the float itself, with no npf_float_t around it.
+
+TEST_CASE("float bits length modifiers, single precision" NPF_FLOAT_PATH) {
+  char a[128], b[128];
+
+  SUBCASE("U32 prints what the float prints") {
+    float const vals[] = {0.0f, -0.0f, 1.0f, -1.5f, 0.1f, 123456.789f, FLT_MAX,
+                          FLT_MIN, FLT_TRUE_MIN, (float)INFINITY, (float)NAN};
+    for (float f : vals) {
+      uint32_t u;
+      memcpy(&u, &f, sizeof(u));
+      int const ra =
+        npf_snprintf_ext(a, sizeof a, "%U32f %.3U32e %U32g %.4U32a", u, u, u, u);
+      int const rb = npf_snprintf(b, sizeof b, "%f %.3e %g %.4a", f, f, f, f);
+      INFO("v=", (double)f);
+      CHECK(std::string{a} == std::string{b});
+      CHECK(ra == rb);
+    }
+  }
+
+  SUBCASE("hex floats of subnormals widen exactly") {
+    npf_snprintf(a, sizeof a, "%a %a", FLT_TRUE_MIN, FLT_MIN / 3.0f);
+    REQUIRE(std::string{a} == "0x1.0000000000000p-149 0x1.5555580000000p-128");
+  }
+
+  SUBCASE("U16 and UB16 print what the float prints") {
+    uint16_t const hs[] = {0x0000, 0x8000, 0x0001, 0x03FF, 0x3C00, 0xC555, 0x7BFF,
+                           0x7C00, 0xFC00, 0x7E00};
+    for (uint16_t h : hs) {
+      uint32_t const bu = (uint32_t)h << 16, hu = (uint32_t)npf_half_to_bits32(h);
+      float bf, hf;
+      memcpy(&bf, &bu, sizeof(bf));
+      memcpy(&hf, &hu, sizeof(hf));
+      npf_snprintf_ext(a, sizeof a, "%.30U16f %U16e %UB16f %.3UB16g", h, h, h, h);
+      npf_snprintf(b, sizeof b, "%.30f %e %f %.3g", hf, hf, bf, bf);
+      INFO("h=", h);
+      CHECK(std::string{a} == std::string{b});
+    }
+  }
+
+  SUBCASE("U64 has no binary64 arithmetic behind it here") {
+    npf_snprintf_ext(a, sizeof a, "%U64f", (uint64_t)0x3FF0000000000000ull);
+    REQUIRE(std::string{a} == "%U64f");
+  }
+}
@@ -0,0 +1,152 @@
+#define NANOPRINTF_USE_FLOAT_EXACT 1
+#include "unit_nanoprintf.h"
+
+#include <cfloat>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <string>
+
+/* With an arena installed, %f/%e/%g print the exact decimal expansion, rounded to
+   nearest with ties to even, so the host printf is the reference: glibc, the
+   macOS libc and the UCRT are all exact. */
+
+namespace {
+
+struct Arena {
+  uint32_t limbs[NPF_EXACT_ARENA_SIZE / 4];
+  Arena() { npf_exact_install(limbs, sizeof(limbs)); }
+  ~Arena() { npf_exact_install(nullptr, 0); }
+};
+
+void compare(char const *fmt, double v) {
+  static char a[1200], b[1200];
+  int const ra = npf_snprintf(a, sizeof(a), fmt, v);
+  int const rb = snprintf(b, sizeof(b), fmt, v);
+  INFO("fmt=", fmt, " v=", v);
+  CHECK(std::string{a} == std::string{b});
+  CHECK(ra == rb);
+}
+
+uint64_t rng_state;
+uint64_t rng() {
+  rng_state ^= rng_state << 13;
+  rng_state ^= rng_state >> 7;
+  rng_state ^= rng_state << 17;
+  return rng_state;
+}
+
+/* No '#' with %g: when rounding adds a digit and switches %#g to style 'e', glibc
+   prints "1.e+02" for %#.2g of 99.9 where C11 7.21.6.1p8 asks for "1.0e+02". */
+char const *const kPatterns[] = {
+  "%%.%df", "%%#.%df", "%%+.%df", "%%-30.%df", "%%030.%df",
+#if NANOPRINTF_USE_FLOAT_SCI_FORMAT_SPECIFIER == 1
+  "%%.%de", "%%#.%dE", "%%+30.%de",
+#endif
+#if NANOPRINTF_USE_FLOAT_SHORTEST_FORMAT_SPECIFIER == 1
+  "%%.%dg", "%%+.%dG", "%%-30.%dg",
+#endif
+};
+constexpr size_t kNumPatterns = sizeof kPatterns / sizeof *kPatterns;
+
+double const kVals[] = {
+  0.0, 1.0, 0.5, 1.5, 2.5, 0.125, 0.1, 0.2, 0.3, 1.0 / 3.0, 2.0 / 3.0, 9.5, 99.5, 0.05,
+  0.15, 0.25, 0.35, 1e15, 1e16, 1e17, 1e21, 1e22, 1e23, 123456789.125, 9.9999999,
+  999999.5, 4294967295.5, 9007199254740993.0, 1e-5, 1e-7, 1e-300, 1e300, DBL_MAX,
+  DBL_MIN, DBL_TRUE_MIN, DBL_EPSILON, 18446744073709551616.0, 9.999999999999999e22,
+};
+
+} // namespace
+
+TEST_CASE("exact floats match the host printf" NPF_FLOAT_PATH) {
+  Arena const arena;
+  char fmt[24];
+
+  SUBCASE("boundary values") {
+    for (double v : kVals) {
+      for (int p : {0, 1, 2, 3, 6, 9, 10, 17, 18, 30, 60, 400, 1100}) {
+        for (size_t k = 0; k < kNumPatterns; ++k) {
+          snprintf(fmt, sizeof fmt, kPatterns[k], p);
+          compare(fmt, v);
+          compare(fmt, -v);
+        }
+      }
+    }
+  }
+
+  SUBCASE("arbitrary bit patterns") {
+    rng_state = 0x0F1E2D3C4B5A6978ull;
+    for (int i = 0; i < 30000; ++i) {
+      union { uint64_t u; double d; } x;
+      x.u = rng();
+      if (std::isnan(x.d) || std::isinf(x.d)) { continue; }
+      snprintf(fmt, sizeof fmt, kPatterns[rng() % kNumPatterns], (int)(rng() % 40));
+      compare(fmt, x.d);
+    }
+  }
+
+  SUBCASE("short decimals, where ties live") {
+    rng_state = 0x1234567887654321ull;
+    for (int i = 0; i < 30000; ++i) {
+      double const v = (double)(rng() % 2000000) / (double)(1u << (rng() % 12));
+      snprintf(fmt, sizeof fmt, kPatterns[rng() % kNumPatterns], (int)(rng() % 12));
+      compare(fmt, v);
+    }
+  }
+}
+
+TEST_CASE("exact floats" NPF_FLOAT_PATH) {
+  char buf[400];
+
+  SUBCASE("every digit of a large integer") {
+    Arena const arena;
+    REQUIRE(npf_snprintf(buf, sizeof(buf), "%.0f", 1e300) == 301);
+    REQUIRE(std::string{buf, 40} == "1000000000000000052504760255204420248704");
+  }
+
+  SUBCASE("fractions past the default engine's accuracy") {
+    Arena const arena;
+    REQUIRE(npf_snprintf(buf, sizeof(buf), "%.20f", 0.1) == 22);
+    REQUIRE(std::string{buf} == "0.10000000000000000555");
+  }
+
+  SUBCASE("ties round to even") {
+    Arena const arena;
+    npf_snprintf(buf, sizeof(buf), "%.0f %.0f %.0f %.1f %.1f", 0.5, 1.5, 2.5, 0.25, 0.375);
+    REQUIRE(std::string{buf} == "0 2 2 0.2 0.4");
+  }
+
+  SUBCASE("field width and padding") {
+    Arena const arena;
+    REQUIRE(npf_snprintf(buf, sizeof(buf), "%+012.3f|%-8.1f|", 3.14159, -2.0) == 22);
+    REQUIRE(std::string{buf} == "+0000003.142|-2.0    |");
+  }
+
+  SUBCASE("specials still print as text") {
+    Arena const arena;
+    npf_snprintf(buf, sizeof(buf), "%f %F %05f", (double)INFINITY, -(double)INFINITY,
+                 (double)NAN);
+    REQUIRE(std::string{buf} == "inf -INF   nan");
+  }
+
+#if NANOPRINTF_USE_FLOAT_SHORTEST_FORMAT_SPECIFIER == 1
+  SUBCASE("%#g keeps the precision's digits when rounding adds one") {
+    Arena const arena;
+    npf_snprintf(buf, sizeof(buf), "%#.2g %#.3g %#.2g", 99.94, 999.9, 9.97);
+    REQUIRE(std::string{buf} == "1.0e+02 1.00e+03 10.");
+  }
+#endif
+
+  SUBCASE("an arena that's too small is refused") {
+    uint32_t limbs[NPF_EXACT_ARENA_SIZE / 4];
+    REQUIRE(!npf_exact_install(limbs, sizeof(limbs) - 1));
+    REQUIRE(npf_exact_install(limbs, sizeof(limbs)));
+    REQUIRE(!npf_exact_install(nullptr, sizeof(limbs)));
+  }
+
+  SUBCASE("without an arena, the default engine runs") {
+    REQUIRE(npf_snprintf(buf, sizeof(buf), "%.0f", 1e300) == 3);
+    REQUIRE(std::string{buf} == "err");
+  }
+}
@@ -0,0 +1,81 @@
+#define NANOPRINTF_USE_FLOAT_BITS_FORMAT_SPECIFIERS 1
+#define NANOPRINTF_USE_FLOAT_HALF_FORMAT_SPECIFIERS 1
+#include "unit_nanoprintf.h"
+
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <string>
+
+/* 'U16' and 'UB16' must print exactly what the plain conversion prints for the
+   value the bits spell, and 'U16' %f must print every digit of it. */
+
+namespace {
+
+double half_value(uint16_t h) {
+  int const e = (h >> 10) & 0x1F, m = h & 0x3FF;
+  double const mag = (e == 0x1F) ? (m ? NAN : INFINITY)
+                   : e ? std::ldexp(m | 0x400, e - 25) : std::ldexp(m, -24);
+  return (h & 0x8000) ? -mag : mag;
+}
+
+double bf16_value(uint16_t b) {
+  uint32_t const u = (uint32_t)b << 16;
+  float f;
+  memcpy(&f, &u, sizeof(f));
+  return (double)f;
+}
+
+} // namespace
+
+TEST_CASE("16-bit float length modifiers" NPF_FLOAT_PATH) {
+  char a[128], b[128];
+
+  SUBCASE("U16 %f prints every digit") {
+    for (uint32_t h = 0; h < 0x10000u; ++h) {
+      double const v = half_value((uint16_t)h);
+      for (int prec : {0, 3, 6, 24}) {
+        npf_snprintf_ext(a, sizeof a, "%.*U16f", prec, (uint16_t)h);
+        snprintf(b, sizeof b, "%.*f", prec, v);
+        if (std::isnan(v)) { snprintf(b, sizeof b, "%snan", std::signbit(v) ? "-" : ""); }
+        INFO("h=", h, " prec=", prec);
+        REQUIRE(std::string{a} == std::string{b});
+      }
+    }
+  }
+
+  SUBCASE("U16 and UB16 print what the double prints") {
+    char const *const fmts[][2] = {
+      {"%.3U16e", "%.3e"}, {"%U16g", "%g"}, {"%U16a", "%a"}, {"%+10.2U16f", "%+10.2f"},
+      {"%.3UB16e", "%.3e"}, {"%UB16g", "%g"}, {"%UB16a", "%a"}, {"%UB16f", "%f"},
+      {"%-12.4UB16f|", "%-12.4f|"},
+    };
+    for (uint32_t h = 0; h < 0x10000u; h += 7) {
+      for (auto const &f : fmts) {
+        bool const bf = (strchr(f[0], 'B') != nullptr);
+        double const v = bf ? bf16_value((uint16_t)h) : half_value((uint16_t)h);
+        int const ra = npf_snprintf_ext(a, sizeof a, f[0], (uint16_t)h);
+        int const rb = npf_snprintf(b, sizeof b, f[1], v);
+        INFO("fmt=", f[0], " h=", h);
+        REQUIRE(std::string{a} == std::string{b});
+        REQUIRE(ra == rb);
+      }
+    }
+  }
+
+  SUBCASE("no float arithmetic widens a half") {
+    for (uint32_t h = 0; h < 0x10000u; ++h) {
+      float const f = (float)half_value((uint16_t)h);
+      uint32_t u;
+      memcpy(&u, &f, sizeof(u));
+      if (std::isnan(f)) { continue; }
+      REQUIRE(npf_half_to_bits32(h) == u);
+    }
+  }
+
+  SUBCASE("other spellings don't parse") {
+    npf_snprintf_ext(a, sizeof a, "%UB32f|%U16d|%UBf", 1u, 2u, 3u);
+    REQUIRE(std::string{a} == "%UB32f|%U16d|%UBf");
+  }
+}
@@ -0,0 +1,150 @@
+#define NANOPRINTF_USE_FLOAT_SINGLE_PRECISION 1
+#define NANOPRINTF_USE_FLOAT_SINGLE_PRECISION_KERNEL 1
+// Large enough that no value and precision below prints "err": FLT_MAX at %.60f.
+#define NANOPRINTF_CONVERSION_BUFFER_SIZE 128
+#include "unit_nanoprintf.h"
+
+#include <cfloat>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <string>
+
+/* The kernel's digits are the exact expansion of the float, rounded to nearest with
+   ties to even, so the host printf of the value widened to double is the reference:
+   widening is exact, and glibc, the macOS libc and the UCRT are all exact. */
+
+namespace {
+
+void compare(char const *fmt, float v) {
+  static char a[256], b[256];
+  int const ra = npf_snprintf(a, sizeof(a), fmt, v);
+  int const rb = snprintf(b, sizeof(b), fmt, (double)v);
+  INFO("fmt=", fmt, " v=", (double)v);
+  CHECK(std::string{a} == std::string{b});
+  CHECK(ra == rb);
+}
+
+uint64_t rng_state;
+uint64_t rng() {
+  rng_state ^= rng_state << 13;
+  rng_state ^= rng_state >> 7;
+  rng_state ^= rng_state << 17;
+  return rng_state;
+}
+
+float from_bits(uint32_t u) {
+  float f;
+  memcpy(&f, &u, sizeof(f));
+  return f;
+}
+
+// No '#' with %g, for the glibc divergence described in unit_float_exact.cc.
+char const *const kPatterns[] = {
+  "%%.%df", "%%#.%df", "%%+.%df", "%%-30.%df", "%%030.%df",
+#if NANOPRINTF_USE_FLOAT_SCI_FORMAT_SPECIFIER == 1
+  "%%.%de", "%%#.%dE", "%%+30.%de",
+#endif
+#if NANOPRINTF_USE_FLOAT_SHORTEST_FORMAT_SPECIFIER == 1
+  "%%.%dg", "%%+.%dG", "%%-30.%dg",
+#endif
+};
+constexpr size_t kNumPatterns = sizeof kPatterns / sizeof *kPatterns;
+
+float const kVals[] = {
+  0.0f, 1.0f, 0.5f, 1.5f, 2.5f, 0.125f, 0.1f, 0.2f, 0.3f, 1.0f / 3.0f, 9.5f, 99.5f,
+  0.05f, 0.15f, 0.25f, 0.35f, 9.9999999f, 999999.5f, 8388607.5f, 16777215.0f,
+  16777216.0f, 4294967295.0f, 4294967296.0f, 1e10f, 1e15f, 1e20f, 1e30f, 1e-5f,
+  1e-10f, 1e-30f, 12345605.0f, 12345650.0f, FLT_MAX, FLT_MIN, FLT_EPSILON,
+  FLT_TRUE_MIN,
+};
+
+} // namespace
+
+TEST_CASE("single-precision kernel matches the host printf" NPF_FLOAT_PATH) {
+  char fmt[24];
+
+  SUBCASE("boundary values") {
+    for (float v : kVals) {
+      for (int p : {0, 1, 2, 3, 6, 8, 9, 10, 17, 30, 60}) {
+        for (size_t k = 0; k < kNumPatterns; ++k) {
+          snprintf(fmt, sizeof fmt, kPatterns[k], p);
+          compare(fmt, v);
+          compare(fmt, -v);
+        }
+      }
+    }
+  }
+
+  SUBCASE("every binary exponent") {
+    for (uint32_t e = 0; e < 255; ++e) {
+      for (uint32_t man : {0u, 1u, 0x7FFFFFu, 0x555555u, 0x400000u}) {
+        for (size_t k = 0; k < kNumPatterns; ++k) {
+          snprintf(fmt, sizeof fmt, kPatterns[k], (int)((e + man) % 24));
+          compare(fmt, from_bits((e << 23) | man));
+        }
+      }
+    }
+  }
+
+  SUBCASE("arbitrary bit patterns") {
+    rng_state = 0x0F1E2D3C4B5A6978ull;
+    for (int i = 0; i < 30000; ++i) {
+      float const v = from_bits((uint32_t)rng());
+      if (std::isnan(v) || std::isinf(v)) { continue; }
+      snprintf(fmt, sizeof fmt, kPatterns[rng() % kNumPatterns], (int)(rng() % 40));
+      compare(fmt, v);
+    }
+  }
+
+  SUBCASE("short decimals, where ties live") {
+    rng_state = 0x1234567887654321ull;
+    for (int i = 0; i < 30000; ++i) {
+      float const v = (float)(rng() % 200000) / (float)(1u << (rng() % 12));
+      snprintf(fmt, sizeof fmt, kPatterns[rng() % kNumPatterns], (int)(rng() % 12));
+      compare(fmt, v);
+    }
+  }
+}
+
+TEST_CASE("single-precision kernel" NPF_FLOAT_PATH) {
+  char buf[128];
+
+#if NANOPRINTF_USE_FLOAT_SCI_FORMAT_SPECIFIER == 1
+  SUBCASE("digits past the ninth are exact") {
+    // The generic scaling prints 1.06994844e+23 here.
+    REQUIRE(npf_snprintf(buf, sizeof(buf), "%.8e", 0x1.6a833cp+76f) == 14);
+    REQUIRE(std::string{buf} == "1.06994845e+23");
+    npf_snprintf(buf, sizeof(buf), "%.16e", 0x1.2ec298p-22f);
+    REQUIRE(std::string{buf} == "2.8196734547236701e-07");
+  }
+#endif
+
+  SUBCASE("every digit of a large integer part") {
+    REQUIRE(npf_snprintf(buf, sizeof(buf), "%.0f", FLT_MAX) == 39);
+    REQUIRE(std::string{buf} == "340282346638528859811704183484516925440");
+  }
+
+  SUBCASE("digits of FLT_MIN past the ninth") {
+    npf_snprintf(buf, sizeof(buf), "%.45f", FLT_MIN);
+    REQUIRE(std::string{buf} == "0.000000000000000000000000000000000000011754944");
+  }
+
+  SUBCASE("every digit of the smallest subnormal's fraction") {
+    REQUIRE(npf_snprintf(buf, sizeof(buf), "%.50f", FLT_TRUE_MIN) == 52);
+    REQUIRE(std::string{buf} == "0.00000000000000000000000000000000000000000000140130");
+  }
+
+  SUBCASE("ties round to even") {
+    npf_snprintf(buf, sizeof(buf), "%.0f %.0f %.0f %.1f %.0f", 0.5f, 1.5f, 2.5f, 0.25f,
+                 8388607.5f);
+    REQUIRE(std::string{buf} == "0 2 2 0.2 8388608");
+  }
+
+  SUBCASE("specials still print as text") {
+    npf_snprintf(buf, sizeof(buf), "%f %F %05f", (float)INFINITY, -(float)INFINITY,
+                 (float)NAN);
+    REQUIRE(std::string{buf} == "inf -INF   nan");
+  }
+}
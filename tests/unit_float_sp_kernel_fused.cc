@@ -0,0 +1,7 @@
+// Same tests as unit_float_sp_kernel.cc with only %f enabled. The kernel compiles
+// npf_etoa_rev for %f in place of npf_ftoa_rev, and this is the configuration where
+// that substitution happens.
+#define NANOPRINTF_USE_FLOAT_SCI_FORMAT_SPECIFIER 0
+#define NANOPRINTF_USE_FLOAT_SHORTEST_FORMAT_SPECIFIER 0
+
+#include "unit_float_sp_kernel.cc"
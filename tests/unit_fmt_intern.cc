@@ -0,0 +1,73 @@
+#define NANOPRINTF_USE_FORMAT_INTERNING 1
+#include "unit_nanoprintf.h"
+
+#include <cstdio>
+#include <string>
+
+/* A record rendered on the "host" must print what npf_snprintf prints on the
+   "device", and be smaller than the text it stands for. */
+
+namespace {
+
+std::string render(std::string const &rec, char const *fmt) {
+  unsigned long id = 0;
+  int const hdr = npf_fmt_read_id(rec.data(), (int)rec.size(), &id);
+  REQUIRE(hdr > 0);
+  REQUIRE(id == npf_fmt_id(fmt));
+  std::string out;
+  int const n = npf_fmt_render(append, &out, fmt, rec.data() + hdr, (int)rec.size() - hdr);
+  REQUIRE(n == (int)out.size());
+  return out;
+}
+
+} // namespace
+
+TEST_CASE("format interning") {
+  SUBCASE("NPF_FMT strings share one section and get distinct IDs") {
+    char const *const a = NPF_FMT("first %d");
+    char const *const b = NPF_FMT("second %s");
+    REQUIRE(std::string{a} == "first %d");
+    REQUIRE(npf_fmt_id(a) != npf_fmt_id(b));
+    REQUIRE(npf_fmt_id(a) < 4096);
+    REQUIRE(npf_fmt_id(b) < 4096);
+  }
+
+  SUBCASE("a record renders as the format would have printed") {
+    char const *const fmt = NPF_FMT("rx %u bytes from %s rssi=%d flags=%#06x %c%%");
+    std::string rec;
+    int const n = npf_fmt_send(append, &rec, fmt, 1500u, "gw-7", -87, 0x2au, '!');
+    REQUIRE(n == (int)rec.size());
+    char ref[128];
+    npf_snprintf(ref, sizeof ref, fmt, 1500u, "gw-7", -87, 0x2au, '!');
+    REQUIRE(render(rec, fmt) == ref);
+    REQUIRE(rec.size() < 16); // the ID, 2+1 varint bytes, 5 string bytes, 1+1+1
+  }
+
+  SUBCASE("stars, long values, pointers and floats") {
+    char const *const fmt = NPF_FMT("[%*d][%-*.*s][%lu][%ld][%p][%.3f][%e]");
+    std::string rec;
+    void *const p = &rec;
+    npf_fmt_send(append, &rec, fmt, -6, 42, 5, 2, "abcdef", 4000000000ul, -3000000000l, p,
+                 -2.5, 6.02e23);
+    char ref[256];
+    npf_snprintf(ref, sizeof ref, fmt, -6, 42, 5, 2, "abcdef", 4000000000ul, -3000000000l,
+                 p, -2.5, 6.02e23);
+    REQUIRE(render(rec, fmt) == ref);
+  }
+
+  SUBCASE("a cut-short record renders what it holds") {
+    char const *const fmt = NPF_FMT("a=%d b=%s c=%d");
+    std::string rec;
+    npf_fmt_send(append, &rec, fmt, 1, "xyz", 3);
+    rec.resize(rec.size() - 3); // into the string
+    REQUIRE(render(rec, fmt) == "a=1 b=");
+  }
+
+  SUBCASE("a conversion capture can't take ends the record") {
+    char const *const fmt = NPF_FMT("%d%n%d");
+    std::string rec;
+    int wb = 0;
+    npf_fmt_send(append, &rec, fmt, 7, &wb, 8);
+    REQUIRE(render(rec, fmt) == "7");
+  }
+}
@@ -0,0 +1,92 @@
+#define NANOPRINTF_USE_HEXDUMP_FORMAT_SPECIFIER 1
+#include "unit_nanoprintf.h"
+
+#include <cstdio>
+#include <string>
+#include <vector>
+
+// "%.*H" dumps a block in one conversion; it must match a loop of "%02X" calls.
+
+namespace {
+
+unsigned char const kBytes[] = {
+  0xDE, 0xAD, 0xBE, 0xEF, 0x00, 0x01, 0x7F, 0x80, 'H', 'i', '!', ' ', '~', 0x1F, 0xFF, 0x0A,
+  0x10, 0x20, 0x30, 0x40, 0x50,
+};
+
+std::string ref(unsigned char const *p, int n, char const *sep) {
+  std::string s;
+  char b[4];
+  for (int i = 0; i < n; ++i) {
+    snprintf(b, sizeof b, "%02X", p[i]);
+    if (i) { s += sep; }
+    s += b;
+  }
+  return s;
+}
+
+} // namespace
+
+TEST_CASE("hexdump conversion") {
+  char a[512];
+
+  SUBCASE("every length matches %02X") {
+    for (int n = 0; n <= (int)sizeof kBytes; ++n) {
+      int const r = npf_snprintf_ext(a, sizeof a, "[%.*H][% .*H]", n, kBytes, n, kBytes);
+      std::string const want = "[" + ref(kBytes, n, "") + "][" + ref(kBytes, n, " ") + "]";
+      REQUIRE(std::string{a} == want);
+      REQUIRE(r == (int)want.size());
+    }
+  }
+
+  SUBCASE("the field width is the bytes per line") {
+    npf_snprintf_ext(a, sizeof a, "% 8.*H", 21, kBytes);
+    REQUIRE(std::string{a} == "DE AD BE EF 00 01 7F 80\n"
+                              "48 69 21 20 7E 1F FF 0A\n"
+                              "10 20 30 40 50");
+    npf_snprintf_ext(a, sizeof a, "%4.*H", 6, kBytes);
+    REQUIRE(std::string{a} == "DEADBEEF\n0001");
+  }
+
+#if NANOPRINTF_USE_ALT_FORM_FLAG == 1
+  SUBCASE("'#' adds an ASCII gutter, aligned on the last line") {
+    int const r = npf_snprintf_ext(a, sizeof a, "%# 8.*H", 21, kBytes);
+    std::string const want = "DE AD BE EF 00 01 7F 80  |........|\n"
+                             "48 69 21 20 7E 1F FF 0A  |Hi! ~...|\n"
+                             "10 20 30 40 50           |. 0@P|";
+    REQUIRE(std::string{a} == want);
+    REQUIRE(r == (int)want.size());
+    npf_snprintf_ext(a, sizeof a, "%#.*H", 3, "ab\n");
+    REQUIRE(std::string{a} == "61620A  |ab.|");
+  }
+#endif
+
+  SUBCASE("no bytes, a negative count and NULL print nothing") {
+    npf_snprintf_ext(a, sizeof a, "[%.0H][%.*H][%.*H]", kBytes, -1, kBytes, 4, nullptr);
+    REQUIRE(std::string{a} == "[][][]");
+  }
+
+  SUBCASE("a count past the width and precision cap is dumped whole") {
+    std::vector<unsigned char> const big(100000, 0xA5);
+    std::string want;
+    for (size_t i = 0; i < big.size(); ++i) { want += "A5"; }
+    std::vector<char> out(want.size() + 1);
+    int const r = npf_snprintf_ext(out.data(), out.size(), "%.*H", (int)big.size(), big.data());
+    REQUIRE(r == (int)want.size());
+    REQUIRE(std::string{out.data()} == want);
+    npf_snprintf_ext(out.data(), out.size(), "%.100000H", big.data());
+    REQUIRE(std::string{out.data()} == want);
+  }
+
+  SUBCASE("a count too big to dump prints ERR, never a shorter dump") {
+    int const r = npf_snprintf_ext(a, sizeof a, "[%.*H][%.1000000000000H]", 1 << 28, kBytes,
+                                   kBytes);
+    REQUIRE(std::string{a} == "[ERR][ERR]");
+    REQUIRE(r == 10);
+  }
+
+  SUBCASE("without a precision or with a length modifier it doesn't parse") {
+    npf_snprintf_ext(a, sizeof a, "%H|%.4lH|%.4hH", kBytes, kBytes, kBytes);
+    REQUIRE(std::string{a} == "%H|%.4lH|%.4hH");
+  }
+}
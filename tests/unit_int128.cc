@@ -0,0 +1,92 @@
+#if defined(__SIZEOF_INT128__)
+#define NANOPRINTF_USE_INT128_FORMAT_SPECIFIERS 1
+#endif
+#include "unit_nanoprintf.h"
+
+#include <cstdint>
+#include <cstdio>
+#include <string>
+
+#if NANOPRINTF_USE_INT128_FORMAT_SPECIFIERS == 1
+
+/* 'w128' takes an __int128; its digits must match the ones the compiler's own
+   128-bit division produces. */
+
+namespace {
+
+__extension__ typedef unsigned __int128 u128;
+__extension__ typedef __int128 i128;
+
+std::string ref(u128 v, unsigned base, bool upper = false) {
+  char const *const digits = upper ? "0123456789ABCDEF" : "0123456789abcdef";
+  std::string s;
+  do { s.insert(s.begin(), digits[(unsigned)(v % base)]); v /= base; } while (v);
+  return s;
+}
+
+u128 const kVals[] = {
+  0, 1, 9, 10, 0xFFFFFFFFu, 0xFFFFFFFFFFFFFFFFull, (u128)1 << 64,
+  ((u128)1 << 64) + 1, (u128)10000000000000000000ull * 10000000000000000000ull,
+  (u128)10000000000000000000ull * 10000000000000000000ull - 1,
+  ((u128)0x8AC7230489E80000ull << 64) - 1, ((u128)0x8AC7230489E80000ull << 64),
+  ((u128)0x0123456789ABCDEFull << 64) | 0xFEDCBA9876543210ull, ~(u128)0, ~(u128)0 >> 1,
+};
+
+} // namespace
+
+TEST_CASE("128-bit fixed-width conversions") {
+  char a[512];
+
+  SUBCASE("%w128u, %w128o, %w128x, %w128X and %w128b") {
+    for (u128 v : kVals) {
+      npf_snprintf(a, sizeof a, "%w128u|%w128o|%w128x|%w128X|%w128b", v, v, v, v, v);
+      REQUIRE(std::string{a} == ref(v, 10) + "|" + ref(v, 8) + "|" + ref(v, 16) + "|" +
+                                ref(v, 16, true) + "|" + ref(v, 2));
+    }
+  }
+
+  SUBCASE("every chunk boundary") {
+    u128 v = 1;
+    for (int i = 0; i < 39; ++i, v *= 10) {
+      for (u128 w : {v - 1, v, v + 1}) {
+        npf_snprintf(a, sizeof a, "%wf128u", w);
+        REQUIRE(std::string{a} == ref(w, 10));
+      }
+    }
+  }
+
+  SUBCASE("%w128d and %w128i") {
+    i128 const min = (i128)((u128)1 << 127), max = (i128)(~(u128)0 >> 1);
+    npf_snprintf(a, sizeof a, "%w128d %w128i %w128d %w128d", min, max, (i128)-1, (i128)0);
+    REQUIRE(std::string{a} == "-170141183460469231731687303715884105728 "
+                              "170141183460469231731687303715884105727 -1 0");
+  }
+
+  SUBCASE("flags, width and precision") {
+    u128 const v = (u128)1 << 100;
+    npf_snprintf(a, sizeof a, "%+45w128d|%-33w128x|%#w128x|%#w128o|%.40w128u|%050w128d",
+                 (i128)v, v, v, v, v, -(i128)v);
+    REQUIRE(std::string{a} ==
+            "             +1267650600228229401496703205376|"
+            "10000000000000000000000000       |"
+            "0x10000000000000000000000000|"
+            "02000000000000000000000000000000000|"
+            "0000000001267650600228229401496703205376|"
+            "-0000000000000000001267650600228229401496703205376");
+    npf_snprintf(a, sizeof a, "[%.0w128u][%#.0w128o]", (u128)0, (u128)0);
+    REQUIRE(std::string{a} == "[][0]");
+  }
+
+  SUBCASE("%w128n") {
+    i128 n = -1;
+    npf_snprintf(a, sizeof a, "abc%w128n", &n);
+    REQUIRE(n == 3);
+  }
+
+  SUBCASE("other conversions and widths don't parse") {
+    npf_snprintf(a, sizeof a, "%w128s|%w128c|%w127d|%w12d", "x", 'c', 1, 2);
+    REQUIRE(std::string{a} == "%w128s|%w128c|%w127d|%w12d");
+  }
+}
+
+#endif
@@ -0,0 +1,105 @@
+#define NANOPRINTF_USE_STRUCTURED_LOG 1
+#include "unit_nanoprintf.h"
+
+#include <cmath>
+#include <string>
+
+/* One format string, three encodings: TEXT must be what npf_pprintf prints, JSON one
+   object and CBOR one map, both with the fields the conversions name. */
+
+namespace {
+
+struct Log {
+  std::string out;
+  npf_log_sink_t sink;
+  explicit Log(int encoding) : sink{append, &out, encoding} {}
+};
+
+std::string bytes(std::initializer_list<int> b) {
+  std::string s;
+  for (int c : b) { s.push_back((char)c); }
+  return s;
+}
+
+} // namespace
+
+TEST_CASE("structured log" NPF_FLOAT_PATH) {
+  SUBCASE("text is what npf_pprintf prints") {
+    Log l(NPF_LOG_TEXT);
+    int const n = npf_log(&l.sink, "temp=%.1f id=%u %s", 21.5, 7u, "ok");
+    REQUIRE(l.out == "temp=21.5 id=7 ok");
+    REQUIRE(n == (int)l.out.size());
+  }
+
+  SUBCASE("JSON names fields and keeps numbers bare") {
+    Log l(NPF_LOG_JSON);
+    int const n = npf_log(&l.sink, "temp=%.2f id=%05u delta: %+d%%", 21.5, 7u, -3);
+    REQUIRE(l.out == "{\"temp\":21.50,\"id\":7,\"delta\":-3}");
+    REQUIRE(n == (int)l.out.size());
+  }
+
+  SUBCASE("JSON quotes and escapes everything else") {
+    Log l(NPF_LOG_JSON);
+    npf_log(&l.sink, "msg=%s flags=%#x c=%c %-4s|", "say \"hi\"\n", 255u, '\\', "ab");
+    REQUIRE(l.out ==
+            "{\"msg\":\"say \\\"hi\\\"\\u000a\",\"flags\":\"0xff\",\"c\":\"\\\\\",\"3\":\"ab  \"}");
+  }
+
+  SUBCASE("JSON can't spell infinity as a number") {
+    Log l(NPF_LOG_JSON);
+    npf_log(&l.sink, "a=%f b=%e", (double)INFINITY, 0.5);
+    REQUIRE(l.out == "{\"a\":\"inf\",\"b\":5.000000e-01}");
+  }
+
+#if NANOPRINTF_USE_FLOAT_STREAMING == 0
+  SUBCASE("JSON writes null where a float couldn't be converted") {
+    Log l(NPF_LOG_JSON);
+    npf_log(&l.sink, "a=%f b=%f c=%.1f", 1e300, -1e300, -0.25);
+    REQUIRE(l.out == "{\"a\":null,\"b\":null,\"c\":-0.2}");
+  }
+#endif
+
+  SUBCASE("JSON writes a NULL string as null, like CBOR") {
+    Log l(NPF_LOG_JSON);
+    npf_log(&l.sink, "s=%s t=%.2s", (char const *)nullptr, "abc");
+    REQUIRE(l.out == "{\"s\":null,\"t\":\"ab\"}");
+  }
+
+  SUBCASE("stars are taken and applied") {
+    Log l(NPF_LOG_JSON);
+    npf_log(&l.sink, "v=%.*f s=%*s", 3, 1.0, -3, "x");
+    REQUIRE(l.out == "{\"v\":1.000,\"s\":\"x  \"}");
+  }
+
+  SUBCASE("CBOR encodes values in binary") {
+    Log l(NPF_LOG_CBOR);
+    int const n =
+      npf_log(&l.sink, "id=%u n=%d big=%lu %s", 500u, -25, 0x12345678ul, "hi");
+    REQUIRE(l.out == bytes({0xBF, 0x62, 'i', 'd', 0x19, 0x01, 0xF4,  // "id": 500
+                            0x61, 'n', 0x38, 0x18,                  // "n": -25
+                            0x63, 'b', 'i', 'g', 0x1A, 0x12, 0x34, 0x56, 0x78,
+                            0x03, 0x62, 'h', 'i',                    // 3: "hi"
+                            0xFF}));
+    REQUIRE(n == (int)l.out.size());
+  }
+
+  SUBCASE("CBOR floats are their IEEE bits") {
+    Log l(NPF_LOG_CBOR);
+    npf_log(&l.sink, "t=%f", 1.5);
+    REQUIRE(l.out == bytes({0xBF, 0x61, 't', 0xFB, 0x3F, 0xF8, 0, 0, 0, 0, 0, 0, 0xFF}));
+  }
+
+  SUBCASE("CBOR strings honor precision and NULL is null") {
+    Log l(NPF_LOG_CBOR);
+    npf_log(&l.sink, "a=%.2s b=%s c=%c", "xyz", (char const *)nullptr, 'q');
+    REQUIRE(l.out == bytes({0xBF, 0x61, 'a', 0x62, 'x', 'y', 0x61, 'b', 0xF6,
+                            0x61, 'c', 0x61, 'q', 0xFF}));
+  }
+
+  SUBCASE("a conversion capture doesn't know ends the record") {
+    Log l(NPF_LOG_JSON);
+    int n = 0;
+    npf_log(&l.sink, "a=%d b=%n c=%d", 1, &n, 2);
+    REQUIRE(l.out == "{\"a\":1}");
+  }
+}
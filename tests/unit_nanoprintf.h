@@ -35,3 +35,8 @@
 #include "../nanoprintf.h"
 
 #include "npf_doctest.h"
+
+#include <string>
+
+// An npf_putc that appends to the std::string in ctx.
+inline void append(int c, void *ctx) { static_cast<std::string *>(ctx)->push_back((char)c); }
@@ -0,0 +1,161 @@
+#define NANOPRINTF_USE_PROFILE_HOOKS 1
+#include "unit_nanoprintf.h"
+
+#include <string>
+#include <vector>
+
+namespace {
+
+struct Recorder {
+  unsigned long now = 0;
+  std::vector<std::string> begins;
+  std::vector<npf_profile_event_t> ends;
+  std::vector<std::string> end_specs;
+};
+
+unsigned long rec_clock(void *ctx) { return ((Recorder *)ctx)->now += 10; }
+
+void rec_begin(void *ctx, npf_profile_event_t const *ev) {
+  ((Recorder *)ctx)->begins.emplace_back(ev->spec, (size_t)ev->spec_len);
+}
+
+void rec_end(void *ctx, npf_profile_event_t const *ev) {
+  Recorder *const r = (Recorder *)ctx;
+  r->ends.push_back(*ev);
+  r->end_specs.emplace_back(ev->spec, (size_t)ev->spec_len);
+}
+
+struct Installed {
+  explicit Installed(npf_profile_hooks_t const *h) { npf_profile_install(h); }
+  ~Installed() { npf_profile_install(nullptr); }
+};
+
+} // namespace
+
+TEST_CASE("profile hooks") {
+  Recorder rec;
+  npf_profile_hooks_t const hooks = { rec_clock, rec_begin, rec_end, &rec };
+  char buf[64];
+
+  SUBCASE("nothing is reported until hooks are installed") {
+    REQUIRE(npf_snprintf(buf, sizeof(buf), "%d", 1) == 1);
+    REQUIRE(rec.begins.empty());
+  }
+
+  SUBCASE("one begin and one end per conversion, none for literal text") {
+    Installed const i{&hooks};
+    REQUIRE(npf_snprintf(buf, sizeof(buf), "a %d b %s c %%", 12, "xy") == 13);
+    REQUIRE(std::string{buf} == "a 12 b xy c %");
+    REQUIRE(rec.begins == std::vector<std::string>{"%d", "%s", "%%"});
+    REQUIRE(rec.end_specs == rec.begins);
+    REQUIRE(rec.ends[0].conv_spec == 'd');
+    REQUIRE(rec.ends[1].conv_spec == 's');
+    REQUIRE(rec.ends[2].conv_spec == '%');
+  }
+
+  SUBCASE("spec covers flags, width, precision and length modifier") {
+    Installed const i{&hooks};
+    npf_snprintf(buf, sizeof(buf), "%-+8.3lX", 0xABul);
+    REQUIRE(rec.end_specs[0] == "%-+8.3lX");
+    REQUIRE(rec.ends[0].conv_spec == 'X');
+    REQUIRE(rec.ends[0].length_modifier != 0);
+  }
+
+  SUBCASE("no length modifier reports 0") {
+    Installed const i{&hooks};
+    npf_snprintf(buf, sizeof(buf), "%u", 5u);
+    REQUIRE(rec.ends[0].length_modifier == 0);
+  }
+
+  SUBCASE("cycles are the clock delta across the conversion") {
+    Installed const i{&hooks};
+    npf_snprintf(buf, sizeof(buf), "%d%d", 1, 2);
+    REQUIRE(rec.ends.size() == 2);
+    REQUIRE(rec.ends[0].start == 10);
+    REQUIRE(rec.ends[0].cycles == 10);
+    REQUIRE(rec.ends[1].start == 30);
+    REQUIRE(rec.ends[1].cycles == 10);
+  }
+
+  SUBCASE("lengths and pads are those of the emitted conversion") {
+    Installed const i{&hooks};
+    npf_snprintf(buf, sizeof(buf), "%8.5d|%-6s|%06x", -42, "ab", 0x1fu);
+    REQUIRE(std::string{buf} == "  -00042|ab    |00001f");
+    REQUIRE(rec.ends[0].cbuf_len == 2);
+    REQUIRE(rec.ends[0].prec_pad == 3);
+    REQUIRE(rec.ends[0].field_pad == 2);
+    REQUIRE(rec.ends[1].cbuf_len == 2);
+    REQUIRE(rec.ends[1].field_pad == 4);
+    REQUIRE(rec.ends[2].cbuf_len == 2);
+    REQUIRE(rec.ends[2].prec_pad == 4); // '0' flag padding folds into prec_pad
+    REQUIRE(rec.ends[2].field_pad == 0);
+  }
+
+  SUBCASE("any hook may be NULL") {
+    npf_profile_hooks_t const end_only = { nullptr, nullptr, rec_end, &rec };
+    Installed const i{&end_only};
+    REQUIRE(npf_snprintf(buf, sizeof(buf), "%c", 'z') == 1);
+    REQUIRE(rec.begins.empty());
+    REQUIRE(rec.ends.size() == 1);
+    REQUIRE(rec.ends[0].cycles == 0);
+  }
+}
+
+TEST_CASE("profile histogram") {
+  npf_profile_hist_t hist{};
+  npf_profile_event_t ev{};
+
+  SUBCASE("rows are per case-folded letter, with '%' last") {
+    REQUIRE(NPF_PROFILE_HIST_ROW('a') == 0);
+    REQUIRE(NPF_PROFILE_HIST_ROW('X') == NPF_PROFILE_HIST_ROW('x'));
+    REQUIRE(NPF_PROFILE_HIST_ROW('z') == 25);
+    REQUIRE(NPF_PROFILE_HIST_ROW('%') == 26);
+  }
+
+  SUBCASE("count, total and max accumulate") {
+    ev.conv_spec = 'd';
+    ev.cycles = 100;
+    npf_profile_hist_end(&hist, &ev);
+    ev.cycles = 300;
+    npf_profile_hist_end(&hist, &ev);
+    auto const &r = hist.row[NPF_PROFILE_HIST_ROW('d')];
+    REQUIRE(r.count == 2);
+    REQUIRE(r.cycles == 400);
+    REQUIRE(r.max == 300);
+  }
+
+  SUBCASE("bucket i holds [2^i, 2^(i+1)) cycles") {
+    ev.conv_spec = 'f';
+    for (unsigned long c : {0ul, 1ul, 2ul, 3ul, 4ul, 1023ul, 1024ul}) {
+      ev.cycles = c;
+      npf_profile_hist_end(&hist, &ev);
+    }
+    auto const &r = hist.row[NPF_PROFILE_HIST_ROW('f')];
+    REQUIRE(r.bucket[0] == 2);
+    REQUIRE(r.bucket[1] == 2);
+    REQUIRE(r.bucket[2] == 1);
+    REQUIRE(r.bucket[9] == 1);
+    REQUIRE(r.bucket[10] == 1);
+  }
+
+  SUBCASE("the last bucket is open-ended") {
+    ev.conv_spec = 'g';
+    ev.cycles = 1ul << 30;
+    npf_profile_hist_end(&hist, &ev);
+    REQUIRE(hist.row[NPF_PROFILE_HIST_ROW('g')].bucket[NPF_PROFILE_HIST_BUCKETS - 1] == 1);
+  }
+
+  SUBCASE("installed as the end hook, it collects from real calls") {
+    npf_profile_hooks_t const hooks = {
+      [](void *) -> unsigned long { static unsigned long t; return t += 5; },
+      nullptr, npf_profile_hist_end, &hist };
+    npf_profile_install(&hooks);
+    char buf[32];
+    npf_snprintf(buf, sizeof(buf), "%d %x %X %%", 1, 2u, 3u);
+    npf_profile_install(nullptr);
+    REQUIRE(hist.row[NPF_PROFILE_HIST_ROW('d')].count == 1);
+    REQUIRE(hist.row[NPF_PROFILE_HIST_ROW('x')].count == 2);
+    REQUIRE(hist.row[NPF_PROFILE_HIST_ROW('%')].count == 1);
+    REQUIRE(hist.row[NPF_PROFILE_HIST_ROW('x')].cycles == 10);
+  }
+}
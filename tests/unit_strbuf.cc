@@ -0,0 +1,119 @@
+#define NANOPRINTF_USE_STRING_BUILDER 1
+#include "unit_nanoprintf.h"
+
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+/* Whatever chunks the text lands in, copying and flattening must give back exactly
+   what one npf_snprintf of the same appends would have. */
+
+namespace {
+
+std::string chunks(npf_strbuf_t const &sb) {
+  std::string s;
+  for (npf_strbuf_chunk_t const *c = &sb.first; c; c = c->next) {
+    s.append(c->data, (size_t)c->len);
+    s += '|';
+  }
+  return s;
+}
+
+// Hands out chunks of a fixed size from the heap, and counts them.
+struct Heap {
+  int size;
+  int limit;
+  std::vector<std::vector<char>> data;
+  std::vector<npf_strbuf_chunk_t> hdr;
+  Heap(int sz, int lim) : size(sz), limit(lim) { hdr.reserve(16); data.reserve(16); }
+  static npf_strbuf_chunk_t *grow(void *ctx, int min) {
+    Heap *const h = static_cast<Heap *>(ctx);
+    if ((int)h->hdr.size() == h->limit) { return nullptr; }
+    int const cap = (min > h->size) ? min : h->size;
+    h->data.emplace_back((size_t)cap);
+    h->hdr.push_back(npf_strbuf_chunk_t{nullptr, h->data.back().data(), cap, 0});
+    return &h->hdr.back();
+  }
+};
+
+} // namespace
+
+TEST_CASE("string builder") {
+  SUBCASE("appends into the first buffer") {
+    char buf[32];
+    npf_strbuf_t sb;
+    npf_strbuf_init(&sb, buf, sizeof buf, nullptr, nullptr);
+    REQUIRE(npf_strbuf_appendf(&sb, "%d-%s", 42, "ab") == 5);
+    REQUIRE(npf_strbuf_appendf(&sb, "|%04x", 0xbeu) == 5);
+    REQUIRE(std::string{npf_strbuf_flatten(&sb)} == "42-ab|00be");
+    REQUIRE(npf_strbuf_flatten(&sb) == buf); // in place, no copy
+  }
+
+  SUBCASE("grows by chunk and splits mid-conversion") {
+    char buf[4];
+    Heap h(5, 8);
+    npf_strbuf_t sb;
+    npf_strbuf_init(&sb, buf, sizeof buf, Heap::grow, &h);
+    npf_strbuf_appendf(&sb, "%s=%u;", "alpha", 123456u);
+    npf_strbuf_appendf(&sb, "%c", 'z');
+    REQUIRE(chunks(sb) == "alph|a=123|456;z|");
+    REQUIRE(sb.len == 14);
+    REQUIRE(h.hdr.size() == 2);
+
+    char out[64];
+    REQUIRE(npf_strbuf_copy(&sb, out, sizeof out) == 14);
+    REQUIRE(std::string{out} == "alpha=123456;z");
+    REQUIRE(npf_strbuf_copy(&sb, out, 6) == 14);
+    REQUIRE(std::string{out} == "alpha");
+  }
+
+  SUBCASE("flattening copies once and keeps appending") {
+    Heap h(3, 8);
+    npf_strbuf_t sb;
+    npf_strbuf_init(&sb, nullptr, 0, Heap::grow, &h);
+    npf_strbuf_appendf(&sb, "%s %d", "report", -7);
+    REQUIRE(chunks(sb) == "|rep|ort| -7|");
+    REQUIRE(std::string{npf_strbuf_flatten(&sb)} == "report -7");
+    REQUIRE(chunks(sb) == "report -7|");
+    npf_strbuf_appendf(&sb, "!");
+    REQUIRE(chunks(sb) == "report -7!|"); // the room past the copy
+  }
+
+  SUBCASE("a failed grow drops the rest") {
+    char buf[4];
+    Heap h(4, 1);
+    npf_strbuf_t sb;
+    npf_strbuf_init(&sb, buf, sizeof buf, Heap::grow, &h);
+    REQUIRE(npf_strbuf_appendf(&sb, "%s", "0123456789") == 10);
+    REQUIRE(sb.len == 10);
+    REQUIRE(sb.dropped == 2);
+    h.limit = 8; // even once memory is back, nothing lands after a gap
+    npf_strbuf_appendf(&sb, "x");
+    REQUIRE(sb.dropped == 3);
+    REQUIRE(std::string{npf_strbuf_flatten(&sb)} == "01234567");
+  }
+
+  SUBCASE("arena chunks") {
+    alignas(void *) char mem[512];
+    npf_strbuf_arena_t a{mem, mem + sizeof mem, 8};
+    npf_strbuf_t sb;
+    npf_strbuf_init(&sb, nullptr, 0, npf_strbuf_arena_grow, &a);
+    std::string ref;
+    for (int i = 0; i < 6; ++i) {
+      npf_strbuf_appendf(&sb, "[%d:%x]", i, (unsigned)(i * 4099));
+      char tmp[32];
+      snprintf(tmp, sizeof tmp, "[%d:%x]", i, (unsigned)(i * 4099));
+      ref += tmp;
+    }
+    REQUIRE(sb.dropped == 0);
+    for (npf_strbuf_chunk_t const *c = sb.first.next; c; c = c->next) {
+      REQUIRE(((uintptr_t)c % sizeof(void *)) == 0);
+      REQUIRE(c->cap == 8);
+    }
+    REQUIRE(std::string{npf_strbuf_flatten(&sb)} == ref);
+
+    npf_strbuf_arena_t tiny{mem, mem + sizeof(npf_strbuf_chunk_t), 8};
+    REQUIRE(npf_strbuf_arena_grow(&tiny, 1) == nullptr);
+  }
+}
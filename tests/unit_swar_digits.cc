@@ -0,0 +1,59 @@
+#define NANOPRINTF_USE_SWAR_DIGIT_CONVERSION 1
+#include "unit_nanoprintf.h"
+
+#include <cstdint>
+#include <cstdio>
+#include <string>
+
+// The eight-at-a-time hex and binary emitters must print what one digit per step does.
+
+namespace {
+
+std::string bin_ref(unsigned long v) {
+  std::string s;
+  do { s.insert(s.begin(), (char)('0' + (v & 1))); v >>= 1; } while (v);
+  return s;
+}
+
+} // namespace
+
+TEST_CASE("SWAR hex and binary digits") {
+  char a[256], b[256];
+  uint64_t x = 0x9E3779B97F4A7C15u;
+  unsigned long const edges[] = {0ul, 1ul, 9ul, 10ul, 15ul, 16ul, 0xFFul, 0x100ul,
+                                 0x7FFFFFFFul, 0x80000000ul, 0xFFFFFFFFul, ~0ul};
+
+  SUBCASE("%x, %X and %p match the host") {
+    for (int i = 0; i < 20000; ++i) {
+      x ^= x << 13; x ^= x >> 7; x ^= x << 17;
+      unsigned long const v = (unsigned long)(x >> (i & 63));
+      npf_snprintf(a, sizeof a, "%lx|%lX|%#lx|%12lx|%.20lX|%x", v, v, v, v, v, (unsigned)v);
+      snprintf(b, sizeof b, "%lx|%lX|%#lx|%12lx|%.20lX|%x", v, v, v, v, v, (unsigned)v);
+      REQUIRE(std::string{a} == std::string{b});
+    }
+    for (unsigned long v : edges) {
+      npf_snprintf(a, sizeof a, "%lx|%lX|%#lX", v, v, v);
+      snprintf(b, sizeof b, "%lx|%lX|%#lX", v, v, v);
+      REQUIRE(std::string{a} == std::string{b});
+    }
+  }
+
+#if NANOPRINTF_USE_BINARY_FORMAT_SPECIFIERS == 1
+  SUBCASE("%b at every length") {
+    unsigned long v = 1;
+    for (int n = 1; n <= (int)(sizeof(long) * 8); ++n, v = (v << 1) | (n & 1)) {
+      npf_snprintf(a, sizeof a, "%lb", v);
+      REQUIRE(std::string{a} == bin_ref(v));
+    }
+    for (unsigned long e : edges) {
+      npf_snprintf(a, sizeof a, "%lb", e);
+      REQUIRE(std::string{a} == bin_ref(e));
+    }
+  }
+
+  SUBCASE("%032b register dumps") {
+    npf_snprintf(a, sizeof a, "%032b|%#010b|%-12b|", 0xA5u, 5u, 0x81u);
+    REQUIRE(std::string{a} == "00000000000000000000000010100101|0b00000101|10000001    |");
+  }
+#endif
+}
@@ -0,0 +1,48 @@
+#define NANOPRINTF_USE_TEE_SINK 1
+#include "unit_nanoprintf.h"
+
+#include <string>
+
+/* Each child must get exactly the bytes one npf_pprintf would have given it, and
+   only for the record classes its filter takes. */
+
+namespace {
+
+enum : unsigned { kError = 1u, kInfo = 2u, kDebug = 4u };
+
+} // namespace
+
+TEST_CASE("tee sink") {
+  std::string uart, ring, file;
+  npf_tee_child_t const kids[] = {
+    {append, &uart, kError},
+    {append, &ring, ~0u},
+    {append, &file, kError | kInfo},
+  };
+  npf_tee_t tee;
+  npf_tee_init(&tee, kids, 3);
+
+  SUBCASE("one pass reaches every taker") {
+    REQUIRE(npf_tee_pprintf(&tee, kError, "e%d:%s;", 1, "boom") == 8);
+    REQUIRE(npf_tee_pprintf(&tee, kInfo, "i%04x;", 0x2au) == 6);
+    REQUIRE(npf_tee_pprintf(&tee, kDebug, "d%u;", 3u) == 3);
+    REQUIRE(uart == "e1:boom;");
+    REQUIRE(ring == "e1:boom;i002a;d3;");
+    REQUIRE(file == "e1:boom;i002a;");
+  }
+
+  SUBCASE("a class nobody takes is skipped") {
+    npf_tee_child_t const quiet[] = {{append, &uart, kError}};
+    npf_tee_t t;
+    npf_tee_init(&t, quiet, 1);
+    REQUIRE(npf_tee_pprintf(&t, kDebug, "%s", "dropped") == 0);
+    REQUIRE(uart.empty());
+  }
+
+  SUBCASE("a record of several classes, and the plain sink") {
+    npf_tee_pprintf(&tee, kError | kDebug, "x");
+    REQUIRE((uart + ring + file) == "xxx");
+    npf_pprintf(npf_tee_putc, &tee, "%c", 'y');
+    REQUIRE((uart + ring + file) == "xyxyxy");
+  }
+}
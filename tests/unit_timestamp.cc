@@ -0,0 +1,99 @@
+#define NANOPRINTF_USE_TIMESTAMP_FORMAT_SPECIFIER 1
+#include "unit_nanoprintf.h"
+
+#include <cstdio>
+#include <ctime>
+#include <string>
+
+/* "%T" and "%#T" must print what a fresh rendering prints however the cached text
+   got there: forward, backward, across a carry or a day, or switching forms. */
+
+namespace {
+
+std::string ts(char const *fmt, npf_timestamp_t *t) {
+  char buf[64];
+  int const n = npf_snprintf_ext(buf, sizeof buf, fmt, t, t, t, t); // one per %T
+  REQUIRE(n == (int)std::string{buf}.size());
+  return buf;
+}
+
+std::string secs_ref(unsigned long s, unsigned long us) {
+  char buf[64];
+  snprintf(buf, sizeof buf, "%lu.%06lu", s, us);
+  return buf;
+}
+
+std::string iso_ref(unsigned long s, unsigned long us) {
+  time_t const t = (time_t)s;
+  struct tm tm;
+  gmtime_r(&t, &tm);
+  char buf[64];
+  snprintf(buf, sizeof buf, "%04d-%02d-%02dT%02d:%02d:%02d.%06luZ", tm.tm_year + 1900,
+           tm.tm_mon + 1, tm.tm_mday, tm.tm_hour, tm.tm_min, tm.tm_sec, us);
+  return buf;
+}
+
+} // namespace
+
+TEST_CASE("timestamp conversion") {
+  SUBCASE("seconds.micros and ISO 8601") {
+    npf_timestamp_t t{};
+    t.sec = 12;
+    t.usec = 250;
+    REQUIRE(ts("%T", &t) == "12.000250");
+    REQUIRE(ts("%#T", &t) == "1970-01-01T00:00:12.000250Z");
+    t.sec = 951782400; // a leap day
+    REQUIRE(ts("%#T", &t) == "2000-02-29T00:00:00.000250Z");
+  }
+
+  SUBCASE("precision picks the fraction digits") {
+    npf_timestamp_t t{};
+    t.sec = 1700000000;
+    t.usec = 123456;
+    REQUIRE(ts("%.3T|%.0T|%.1T|%.9T", &t) == "1700000000.123|1700000000|1700000000.1|1700000000.123456");
+    REQUIRE(ts("%#.3T", &t) == "2023-11-14T22:13:20.123Z");
+    REQUIRE(ts("%#.0T", &t) == "2023-11-14T22:13:20Z");
+  }
+
+  SUBCASE("the cached text follows the clock") {
+    npf_timestamp_t a{}, b{};
+    unsigned long const starts[] = {0, 9, 99, 86399, 946684799, 4102444799ul};
+    unsigned long const steps[] = {1, 1, 3, 60, 7, 3599, 86400, 1, 123457};
+    for (unsigned long s : starts) {
+      a.sec = b.sec = s;
+      for (unsigned long step : steps) {
+        a.sec += step;
+        b.sec += step;
+        a.usec = b.usec = (a.sec * 7919u) % 1000000u;
+        INFO("sec=", a.sec);
+        REQUIRE(ts("%T", &a) == secs_ref(a.sec, a.usec));
+        REQUIRE(ts("%#T", &b) == iso_ref(b.sec, b.usec));
+      }
+    }
+  }
+
+  SUBCASE("going back or switching forms renders afresh") {
+    npf_timestamp_t t{};
+    t.sec = 1000;
+    REQUIRE(ts("%T", &t) == "1000.000000");
+    t.sec = 999;
+    REQUIRE(ts("%T", &t) == "999.000000");
+    REQUIRE(ts("%#T %T", &t) == "1970-01-01T00:16:39.000000Z 999.000000");
+    t.sec = 100000;
+    REQUIRE(ts("%T %#T", &t) == "100000.000000 1970-01-02T03:46:40.000000Z");
+  }
+
+  SUBCASE("width pads it like a string") {
+    npf_timestamp_t t{};
+    t.sec = 5;
+    REQUIRE(ts("[%12.3T][%-8.1T]", &t) == "[       5.000][5.0     ]");
+  }
+
+  SUBCASE("a NULL context prints nothing and modifiers don't parse") {
+    char buf[32];
+    npf_snprintf_ext(buf, sizeof buf, "[%T%#T]", nullptr, nullptr);
+    REQUIRE(std::string{buf} == "[]");
+    npf_snprintf_ext(buf, sizeof buf, "%lT|%hT|%t", nullptr, nullptr, nullptr);
+    REQUIRE(std::string{buf} == "%lT|%hT|%t");
+  }
+}
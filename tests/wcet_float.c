@@ -0,0 +1,148 @@
+/*
+  Worst-case search over the float generators, run on an emulated Cortex-M by
+  wcet_float.py. See npf_cortex_m.h for how ticks become instructions.
+
+  Each conversion the configuration compiles is timed as a whole npf_pprintf call
+  into a discarding sink, because that is the bound a real-time task has to budget
+  for; the generator behind it (npf_ftoa_rev, npf_etoa_rev or npf_atoa_rev) is
+  where nearly all of the variation comes from. Runtime depends on the binary
+  exponent, on whether the value is subnormal, and on how long rounding carries
+  run, so the search:
+
+    1. Sweeps every finite binary exponent, subnormals included, with a handful of
+       mantissa patterns that stress different paths: zero, the lowest bit, all
+       ones (the longest carries), alternating bits, and the top bit alone.
+    2. Hill-climbs from the slowest input found, flipping one mantissa or exponent
+       bit at a time and keeping any flip that makes the call slower, until a full
+       pass over the bits finds nothing.
+
+  This is a search, not a proof: the result is a tight lower bound on the worst
+  case, pinned so that regressions show up.
+
+  Each line of output is one of:
+    CAL <spin count> <ticks>
+    WORST <conversion> <precision> <ticks> <input bits as hex>
+    DONE
+*/
+
+#define NANOPRINTF_IMPLEMENTATION
+#include "nanoprintf.h"
+
+#include "npf_cortex_m.h"
+
+#if (NANOPRINTF_USE_FLOAT_FORMAT_SPECIFIERS != 1) || \
+    (NANOPRINTF_USE_PRECISION_FORMAT_SPECIFIERS != 1)
+  #error wcet_float.c needs the float and precision format specifiers
+#endif
+
+#if NANOPRINTF_USE_FLOAT_SINGLE_PRECISION == 1
+typedef float real_t;
+typedef uint32_t real_bits_t;
+enum { MAN_BITS = 23, EXP_BITS = 8 };
+#else
+typedef double real_t;
+typedef uint64_t real_bits_t;
+enum { MAN_BITS = 52, EXP_BITS = 11 };
+#endif
+
+#define MAN_MASK ((((real_bits_t)1) << MAN_BITS) - 1)
+#define EXP_MASK ((((real_bits_t)1) << EXP_BITS) - 1) // all ones is inf / nan
+
+static real_t from_bits(real_bits_t b) {
+  union { real_bits_t b; real_t f; } u;
+  u.b = b;
+  return u.f;
+}
+
+static int is_finite(real_bits_t b) { return ((b >> MAN_BITS) & EXP_MASK) != EXP_MASK; }
+
+typedef void (*conv_fn)(int prec, real_t v);
+
+#define NPF_WCET_CONV(NAME, FMT) \
+  static __attribute__((noinline)) void NAME(int prec, real_t v) { \
+    npf_pprintf(null_putc, NULL, FMT, prec, v); \
+  }
+
+NPF_WCET_CONV(conv_f, "%.*f")
+#if NANOPRINTF_USE_FLOAT_SCI_FORMAT_SPECIFIER == 1
+NPF_WCET_CONV(conv_e, "%.*e")
+#endif
+#if NANOPRINTF_USE_FLOAT_SHORTEST_FORMAT_SPECIFIER == 1
+NPF_WCET_CONV(conv_g, "%.*g")
+#endif
+#if NANOPRINTF_USE_FLOAT_HEX_FORMAT_SPECIFIER == 1
+NPF_WCET_CONV(conv_a, "%.*a")
+#endif
+
+/* Precisions searched per conversion: none, the default, and enough digits to
+   round-trip a double. A negative precision is taken as omitted, which for %a
+   means "exact". */
+static struct { char const *name; conv_fn fn; int precs[3]; } const convs[] = {
+  { "%f", conv_f, { 0, 6, 17 } },
+#if NANOPRINTF_USE_FLOAT_SCI_FORMAT_SPECIFIER == 1
+  { "%e", conv_e, { 0, 6, 17 } },
+#endif
+#if NANOPRINTF_USE_FLOAT_SHORTEST_FORMAT_SPECIFIER == 1
+  { "%g", conv_g, { 1, 6, 17 } },
+#endif
+#if NANOPRINTF_USE_FLOAT_HEX_FORMAT_SPECIFIER == 1
+  { "%a", conv_a, { -1, 0, 6 } },
+#endif
+};
+
+static unsigned measure(conv_fn fn, int prec, real_bits_t bits) {
+  real_t const v = from_bits(bits);
+  uint32_t const t0 = ticks();
+  fn(prec, v);
+  uint32_t const t1 = ticks();
+  return elapsed(t0, t1);
+}
+
+typedef struct { unsigned ticks; real_bits_t bits; } worst_t;
+
+static int consider(worst_t *w, conv_fn fn, int prec, real_bits_t bits) {
+  unsigned const t = measure(fn, prec, bits);
+  if (t <= w->ticks) { return 0; }
+  w->ticks = t;
+  w->bits = bits;
+  return 1;
+}
+
+static worst_t search(conv_fn fn, int prec) {
+  static real_bits_t const mantissas[] = {
+    0, 1, MAN_MASK, MAN_MASK / 3, ((real_bits_t)1) << (MAN_BITS - 1)
+  };
+  worst_t w = { 0, 0 };
+
+  for (real_bits_t e = 0; e < EXP_MASK; ++e) {
+    for (unsigned m = 0; m < sizeof(mantissas) / sizeof(*mantissas); ++m) {
+      consider(&w, fn, prec, (e << MAN_BITS) | mantissas[m]);
+    }
+  }
+
+  for (int improved = 1; improved;) {
+    improved = 0;
+    for (int bit = 0; bit < MAN_BITS + EXP_BITS; ++bit) {
+      real_bits_t const cand = w.bits ^ (((real_bits_t)1) << bit);
+      if (is_finite(cand)) { improved |= consider(&w, fn, prec, cand); }
+    }
+  }
+  return w;
+}
+
+int main(void) {
+  npf_cortex_m_start();
+
+  for (unsigned c = 0; c < sizeof(convs) / sizeof(*convs); ++c) {
+    for (unsigned p = 0; p < 3; ++p) {
+      worst_t const w = search(convs[c].fn, convs[c].precs[p]);
+      npf_snprintf(line, sizeof line, "WORST %s %d %u %08x%08x\n", convs[c].name,
+        convs[c].precs[p], w.ticks, (unsigned)(uint32_t)((uint64_t)w.bits >> 32),
+        (unsigned)(uint32_t)w.bits);
+      put_s(line);
+    }
+  }
+
+  put_s("DONE\n");
+  return 0;
+}
@@ -0,0 +1,128 @@
+"""Search for the slowest float conversions and hold them to pinned thresholds.
+
+Needs what cycle_report.py needs: arm-none-eabi-gcc and qemu-system-arm. The search
+itself runs on the emulated core, in wcet_float.c. For every configuration below, each
+(conversion, precision) pair's slowest input is compared against wcet_float.json; a
+count above its threshold is a regression and fails the run, and so does a pair with
+no threshold or a configuration whose search reports nothing. Counts are instructions
+retired by the whole npf_pprintf call, so they bound execution time only as far as an
+instruction count does on the real core (see cycle_report.py).
+
+After a change that makes a conversion slower on purpose, or a toolchain update,
+regenerate the thresholds with --update and review the diff like any other.
+"""
+
+import argparse
+import json
+import pathlib
+import re
+import struct
+import sys
+
+import cycle_report
+
+# The search makes a few hundred thousand calls per configuration.
+_TIMEOUT_SEC = 600
+
+_THRESHOLDS = pathlib.Path(__file__).with_suffix(".json")
+
+_EVERYTHING = cycle_report._EVERYTHING  # noqa: SLF001
+_flags = cycle_report._flags  # noqa: SLF001
+
+# (name, flags). %f by itself compiles npf_ftoa_rev; everything else shares
+# npf_etoa_rev, with npf_atoa_rev behind %a.
+_CONFIGS = [
+    ("Fused %f", _flags(
+        FIELD_WIDTH_FORMAT_SPECIFIERS=1, PRECISION_FORMAT_SPECIFIERS=1,
+        FLOAT_FORMAT_SPECIFIERS=1, SMALL_FORMAT_SPECIFIERS=1, ALT_FORM_FLAG=1)),
+    ("Everything", _flags(**_EVERYTHING)),
+    ("Everything, division-free", _flags(**_EVERYTHING, DIVISION_FREE_CONVERSION=1)),
+    ("Everything, single-precision", _flags(**_EVERYTHING, FLOAT_SINGLE_PRECISION=1)),
+]
+
+
+def _parse_args() -> argparse.Namespace:
+    """Parse and validate command-line arguments."""
+    parser = argparse.ArgumentParser()
+    parser.add_argument(
+        "-p",
+        "--platform",
+        choices=tuple(cycle_report._PLATFORMS),  # noqa: SLF001
+        required=True,
+        help="target platform to search on",
+    )
+    parser.add_argument(
+        "--update",
+        action="store_true",
+        help="rewrite this platform's thresholds from the search instead of checking",
+    )
+    return parser.parse_args()
+
+
+def _value(bits: str, single: bool) -> str:
+    """The input the search settled on, readably."""
+    n = int(bits, 16)
+    if single:
+        return repr(struct.unpack("<f", struct.pack("<I", n))[0])
+    return repr(struct.unpack("<d", struct.pack("<Q", n))[0])
+
+
+def _search(platform: str, flags: list[str]) -> list[tuple[str, int, str]]:
+    """Run the search, return (conversion + precision, instructions, input bits)."""
+    src = pathlib.Path(__file__).with_suffix(".c")
+    out = cycle_report.run(platform, flags, src=src, timeout=_TIMEOUT_SEC)
+    ticks_per_insn = cycle_report.ticks_per_instruction(out)
+    return [
+        (f"{conv} .{prec}", round(int(t) / ticks_per_insn), bits)
+        for conv, prec, t, bits in re.findall(
+            r"^WORST (\S+) (-?\d+) (\d+) ([0-9a-f]+)$", out, re.MULTILINE)
+    ]
+
+
+def main() -> int:
+    """Entry point"""
+    args = _parse_args()
+    pinned = json.loads(_THRESHOLDS.read_text(encoding="utf-8"))
+    thresholds = pinned.setdefault(args.platform, {})
+    failures = 0
+    unpinned = 0
+
+    for name, flags in _CONFIGS:
+        single = "-DNANOPRINTF_USE_FLOAT_SINGLE_PRECISION=1" in flags
+        print(f'Configuration "{name}":')
+        found = _search(args.platform, flags)
+        if not found:
+            print(f'No WORST lines from "{name}"; the search did not run.',
+                  file=sys.stderr)
+            return 1
+        limits = thresholds.setdefault(name, {})
+        for key, insns, bits in found:
+            limit = limits.get(key)
+            verdict = "(unpinned)" if limit is None else f"/ {limit}"
+            unpinned += limit is None
+            if limit is not None and insns > limit:
+                verdict += "  REGRESSION"
+                failures += 1
+            print(f"  {key:<7} {insns:>7} {verdict:<18} {_value(bits, single)}")
+            if args.update:
+                limits[key] = insns
+        print()
+
+    if args.update:
+        _THRESHOLDS.write_text(
+            json.dumps(pinned, indent=2, sort_keys=True) + "\n",
+            encoding="utf-8", newline="\n")
+        print(f"Updated {_THRESHOLDS.name} for {args.platform}.")
+        return 0
+
+    if unpinned:
+        print(f"{unpinned} conversion(s) have no threshold in {_THRESHOLDS.name}; "
+              f"run with --update to pin them", file=sys.stderr)
+    if failures:
+        print(f"{failures} conversion(s) slower than pinned; see {_THRESHOLDS.name}",
+              file=sys.stderr)
+    return 1 if (failures or unpinned) else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())